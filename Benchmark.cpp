@@ -0,0 +1,85 @@
+#include "Benchmark.h"
+#include <inttypes.h>
+
+Benchmark::Benchmark(Preferences& prefs) : preferences(prefs) {}
+
+void Benchmark::begin() {
+    preferences.begin("bench", true);
+    thresholdPercent = preferences.getUChar("threshold", 20);
+    size_t length = preferences.getBytes("base", baseline, sizeof(baseline));
+    baselineCount = length / sizeof(BenchBaseline);
+    preferences.end();
+}
+
+void Benchmark::measure(const char* name, BenchFn fn, void* context) {
+    if (resultCount >= BENCH_MAX_CASES) return;
+
+    fn(context); // rozgrzanie: cache flash, pierwsze wywołania sterownika
+    size_t bytes = 0;
+    uint32_t start = ESP.getCycleCount();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) bytes += fn(context);
+    uint32_t cycles = ESP.getCycleCount() - start;
+
+    BenchResult& result = results[resultCount++];
+    result.name = name;
+    result.nsPerCall = (uint64_t)cycles * 1000 / ESP.getCpuFreqMHz() / BENCH_ITERATIONS;
+    result.bytesPerCall = bytes / BENCH_ITERATIONS;
+}
+
+const BenchBaseline* Benchmark::findBaseline(const char* name) const {
+    for (int i = 0; i < baselineCount; i++) {
+        if (strncmp(baseline[i].name, name, BENCH_NAME_LEN) == 0) return &baseline[i];
+    }
+    return nullptr;
+}
+
+bool Benchmark::regressed(const BenchResult& result, const BenchBaseline* base) const {
+    if (!base) return false;
+    uint64_t limit = 100 + thresholdPercent;
+    return (uint64_t)result.nsPerCall * 100 > base->nsPerCall * limit ||
+           (uint64_t)result.bytesPerCall * 100 > base->bytesPerCall * limit;
+}
+
+int Benchmark::regressions() const {
+    int count = 0;
+    for (int i = 0; i < resultCount; i++) {
+        if (regressed(results[i], findBaseline(results[i].name))) count++;
+    }
+    return count;
+}
+
+void Benchmark::saveBaseline() {
+    baselineCount = resultCount;
+    for (int i = 0; i < resultCount; i++) {
+        strlcpy(baseline[i].name, results[i].name, BENCH_NAME_LEN);
+        baseline[i].nsPerCall = results[i].nsPerCall;
+        baseline[i].bytesPerCall = results[i].bytesPerCall;
+    }
+    preferences.begin("bench", false);
+    preferences.putBytes("base", baseline, baselineCount * sizeof(BenchBaseline));
+    preferences.end();
+}
+
+void Benchmark::setThreshold(uint8_t percent) {
+    thresholdPercent = percent;
+    preferences.begin("bench", false);
+    preferences.putUChar("threshold", percent);
+    preferences.end();
+}
+
+void Benchmark::writeJson(TextBuffer& out) const {
+    out.appendf("{\"iterations\":%d,\"cpuMHz\":%" PRIu32 ",\"thresholdPct\":%u,\"regressions\":%d,\"results\":[",
+                BENCH_ITERATIONS, ESP.getCpuFreqMHz(), thresholdPercent, regressions());
+    for (int i = 0; i < resultCount; i++) {
+        const BenchResult& r = results[i];
+        out.appendf("%s{\"name\":\"%s\",\"ns\":%" PRIu32 ",\"bytes\":%" PRIu32,
+                    i ? "," : "", r.name, r.nsPerCall, r.bytesPerCall);
+        const BenchBaseline* base = findBaseline(r.name);
+        if (base) {
+            out.appendf(",\"baseNs\":%" PRIu32 ",\"baseBytes\":%" PRIu32 ",\"regressed\":%s",
+                        base->nsPerCall, base->bytesPerCall, regressed(r, base) ? "true" : "false");
+        }
+        out.append("}");
+    }
+    out.append("]}");
+}
@@ -0,0 +1,56 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "TextBuffer.h"
+
+#define BENCH_MAX_CASES 8
+#define BENCH_NAME_LEN 16
+#define BENCH_ITERATIONS 50
+
+struct BenchResult {
+    const char* name;
+    uint32_t nsPerCall;
+    uint32_t bytesPerCall;  // wyjście jednego wywołania (strona, pakiet, tekst)
+};
+
+// Wynik zapisany jako baza do porównań (NVS "bench")
+struct BenchBaseline {
+    char name[BENCH_NAME_LEN];
+    uint32_t nsPerCall;
+    uint32_t bytesPerCall;
+};
+
+// Mikrobenchmark gorących ścieżek uruchamiany na urządzeniu. Każdy przypadek
+// jest wywoływany BENCH_ITERATIONS razy na stałych danych wejściowych; czas
+// liczony jest w cyklach CPU, a wynik porównywany z bazą zapisaną w NVS.
+// Wzrost czasu lub rozmiaru wyjścia ponad próg [%] to regresja. Liczby
+// alokacji nie da się tu zmierzyć - sprawdza je tools/hotpath_bench na hoście.
+class Benchmark {
+public:
+    typedef size_t (*BenchFn)(void* context); // zwraca liczbę bajtów wyjścia
+
+    explicit Benchmark(Preferences& prefs);
+    void begin();
+    void clear() { resultCount = 0; }
+    void measure(const char* name, BenchFn fn, void* context);
+
+    int regressions() const;
+    void saveBaseline();
+    void setThreshold(uint8_t percent);
+    void writeJson(TextBuffer& out) const;
+
+private:
+    const BenchBaseline* findBaseline(const char* name) const;
+    bool regressed(const BenchResult& result, const BenchBaseline* base) const;
+
+    Preferences& preferences;
+    BenchResult results[BENCH_MAX_CASES];
+    int resultCount = 0;
+    BenchBaseline baseline[BENCH_MAX_CASES] = {};
+    int baselineCount = 0;
+    uint8_t thresholdPercent = 20;
+};
+
+#endif
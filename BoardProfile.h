@@ -0,0 +1,38 @@
+#ifndef BOARD_PROFILE_H
+#define BOARD_PROFILE_H
+
+// Profile płytek z pinami znanymi w czasie kompilacji.
+// Aby użyć profilu, zdefiniuj przed kompilacją (np. w build_opt.h lub flagach):
+//   #define BOARD_PROFILE BoardEsp32C6DevKit
+// Bez BOARD_PROFILE działa ogólna ścieżka z pinami z konfiguracji (NVS).
+// -1 oznacza brak czujnika/przycisku - odpowiedni kod nie jest kompilowany.
+
+struct BoardEsp32C6DevKit {
+    static constexpr const char* name = "esp32c6-devkit";
+    static constexpr int lowPin = 4;
+    static constexpr int highPin = 5;
+    static constexpr int midPin = -1;
+    static constexpr int relayPin = 6;
+    static constexpr int buttonPin = 9; // BOOT
+};
+
+struct BoardEsp32C6ThreeSensors {
+    static constexpr const char* name = "esp32c6-3sensors";
+    static constexpr int lowPin = 4;
+    static constexpr int highPin = 5;
+    static constexpr int midPin = 7;
+    static constexpr int relayPin = 6;
+    static constexpr int buttonPin = 9; // BOOT
+};
+
+// Domyślne piny z loadConfig() dla klasycznego ESP32
+struct BoardEsp32Classic {
+    static constexpr const char* name = "esp32-classic";
+    static constexpr int lowPin = 34;
+    static constexpr int highPin = 35;
+    static constexpr int midPin = -1;
+    static constexpr int relayPin = 25;
+    static constexpr int buttonPin = -1;
+};
+
+#endif
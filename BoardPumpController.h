@@ -0,0 +1,103 @@
+#ifndef BOARD_PUMP_CONTROLLER_H
+#define BOARD_PUMP_CONTROLLER_H
+
+#include <Arduino.h>
+#include <soc/soc.h>
+#include <soc/gpio_reg.h>
+#include "PumpController.h"
+#include "BoardProfile.h"
+
+// Maski bitów pinu w rejestrach GPIO (piny 0-31 i 32-63); -1 daje maskę 0
+template <int Pin>
+struct PinMask {
+    static_assert(Pin < 64, "Nieprawidłowy numer pinu");
+    static constexpr uint32_t low = (Pin >= 0 && Pin < 32) ? (1UL << (Pin & 31)) : 0;
+    static constexpr uint32_t high = (Pin >= 32) ? (1UL << (Pin & 31)) : 0;
+};
+
+// Wejścia płytki odczytywane jednym maskowanym odczytem rejestru GPIO_IN
+// (dwoma, jeśli profil używa pinów >= 32 na klasycznym ESP32)
+template <class Board>
+struct BoardInputs {
+    static constexpr bool hasMid = Board::midPin >= 0;
+    static constexpr bool hasButton = Board::buttonPin >= 0;
+    static constexpr uint32_t maskLow = PinMask<Board::lowPin>::low | PinMask<Board::highPin>::low |
+                                        PinMask<Board::midPin>::low | PinMask<Board::buttonPin>::low;
+    static constexpr uint32_t maskHigh = PinMask<Board::lowPin>::high | PinMask<Board::highPin>::high |
+                                         PinMask<Board::midPin>::high | PinMask<Board::buttonPin>::high;
+#ifndef GPIO_IN1_REG
+    static_assert(maskHigh == 0 && Board::relayPin < 32, "Ten układ ma tylko jeden bank GPIO (piny 0-31)");
+#endif
+
+    template <int Pin>
+    static inline bool active(uint32_t low, uint32_t high) {
+        return (low & PinMask<Pin>::low) || (high & PinMask<Pin>::high);
+    }
+
+    static inline uint8_t read() {
+        // Czujniki i przycisk są aktywne stanem niskim
+        uint32_t low = 0, high = 0;
+        if constexpr (maskLow != 0) low = ~REG_READ(GPIO_IN_REG) & maskLow;
+#ifdef GPIO_IN1_REG
+        if constexpr (maskHigh != 0) high = ~REG_READ(GPIO_IN1_REG) & maskHigh;
+#endif
+        uint8_t inputs = 0;
+        if (active<Board::lowPin>(low, high)) inputs |= PUMP_IN_LOW;
+        if (active<Board::highPin>(low, high)) inputs |= PUMP_IN_HIGH;
+        if constexpr (hasMid) {
+            if (active<Board::midPin>(low, high)) inputs |= PUMP_IN_MID;
+        }
+        if constexpr (hasButton) {
+            if (active<Board::buttonPin>(low, high)) inputs |= PUMP_IN_BUTTON;
+        }
+        return inputs;
+    }
+
+    static inline void writeRelay(bool on) {
+        if constexpr (Board::relayPin < 32) {
+            REG_WRITE(on ? GPIO_OUT_W1TS_REG : GPIO_OUT_W1TC_REG, PinMask<Board::relayPin>::low);
+        }
+#ifdef GPIO_OUT1_W1TS_REG
+        else {
+            REG_WRITE(on ? GPIO_OUT1_W1TS_REG : GPIO_OUT1_W1TC_REG, PinMask<Board::relayPin>::high);
+        }
+#endif
+    }
+};
+
+// Sterownik pompy dla płytki o pinach znanych w czasie kompilacji. Logika
+// sterowania jest wspólna z PumpController; różni się tylko odczyt wejść
+// i zapis przekaźnika - bez warstwy Arduino i bez sprawdzeń "pin != -1".
+template <class Board>
+class BoardPumpController final : public PumpController {
+public:
+    using PumpController::PumpController;
+
+    void begin() {
+        PumpController::begin(Board::lowPin, Board::highPin, Board::midPin, Board::relayPin, Board::buttonPin);
+        benchmarkInputs();
+    }
+
+protected:
+    uint8_t sampleInputs() override { return BoardInputs<Board>::read(); }
+    void writeRelay(bool on) override { BoardInputs<Board>::writeRelay(on); }
+    const char* profileName() const override { return Board::name; }
+
+private:
+    // Porównanie kosztu odczytu wejść: ścieżka ogólna vs profil płytki
+    void benchmarkInputs() {
+        const int iterations = 1000;
+        volatile uint8_t sink = 0;
+
+        uint32_t start = ESP.getCycleCount();
+        for (int i = 0; i < iterations; i++) sink = sink | sampleRuntimeInputs();
+        benchRuntimeCycles = (ESP.getCycleCount() - start) / iterations;
+
+        start = ESP.getCycleCount();
+        for (int i = 0; i < iterations; i++) sink = sink | BoardInputs<Board>::read();
+        benchStaticCycles = (ESP.getCycleCount() - start) / iterations;
+        (void)sink;
+    }
+};
+
+#endif
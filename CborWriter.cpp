@@ -0,0 +1,27 @@
+#include "CborWriter.h"
+
+void CborWriter::writeByte(uint8_t b) {
+    if (len < cap) buf[len++] = b;
+    else overflowed = true;
+}
+
+// Nagłówek: typ główny w 3 najstarszych bitach, wartość w najkrótszej formie
+void CborWriter::writeHead(uint8_t major, uint64_t value) {
+    uint8_t type = major << 5;
+    if (value < 24) {
+        writeByte(type | value);
+    } else if (value <= 0xff) {
+        writeByte(type | 24);
+        writeByte(value);
+    } else if (value <= 0xffff) {
+        writeByte(type | 25);
+        writeByte(value >> 8);
+        writeByte(value);
+    } else if (value <= 0xffffffffULL) {
+        writeByte(type | 26);
+        for (int shift = 24; shift >= 0; shift -= 8) writeByte(value >> shift);
+    } else {
+        writeByte(type | 27);
+        for (int shift = 56; shift >= 0; shift -= 8) writeByte(value >> shift);
+    }
+}
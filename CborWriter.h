@@ -0,0 +1,30 @@
+#ifndef CBOR_WRITER_H
+#define CBOR_WRITER_H
+
+#include <Arduino.h>
+
+// Minimalny koder CBOR (RFC 8949) do stałego bufora: mapy, liczby
+// nieujemne i wartości logiczne - tyle, ile potrzebuje rekord stanu.
+class CborWriter {
+public:
+    CborWriter(uint8_t* buffer, size_t capacity) : buf(buffer), cap(capacity) {}
+
+    void writeMap(size_t entries) { writeHead(5, entries); }
+    void writeUInt(uint64_t value) { writeHead(0, value); }
+    void writeBool(bool value) { writeByte(value ? 0xf5 : 0xf4); }
+
+    const uint8_t* data() const { return buf; }
+    size_t length() const { return len; }
+    bool overflow() const { return overflowed; }
+
+private:
+    void writeHead(uint8_t major, uint64_t value);
+    void writeByte(uint8_t b);
+
+    uint8_t* buf;
+    size_t cap;
+    size_t len = 0;
+    bool overflowed = false;
+};
+
+#endif
@@ -2,26 +2,41 @@
 #include <Preferences.h>
 #include <ESPmDNS.h>
 #include "SystemState.h"
+#include "HeapMonitor.h"
+#include "Logger.h"
+#include "Scheduler.h"
 #include "WaterMonitorMQTT.h"
 #include "Notifier.h"
 #include "PumpController.h"
+#include "BoardPumpController.h"
 #include "WebInterface.h"
+#include "Fleet.h"
 
 // --- Obiekty globalne ---
 Preferences preferences;
 SystemState systemState;
+Scheduler scheduler;
 WaterMonitorMQTT waterMQTT;
 Notifier notifier(systemState);
-PumpController pumpController(systemState, notifier);
-WebInterface webInterface(systemState, waterMQTT, pumpController, preferences);
+Fleet fleet(systemState);
+#ifdef BOARD_PROFILE
+BoardPumpController<BOARD_PROFILE> pumpController(systemState, notifier); // piny z profilu płytki
+#else
+PumpController pumpController(systemState, notifier); // piny z konfiguracji
+#endif
+WebInterface webInterface(systemState, waterMQTT, pumpController, preferences, scheduler, fleet);
 
 // --- Zmienne konfiguracyjne ---
-String ssid, pass, pushoverToken, pushoverUser;
+String ssid, pass, pushoverToken, pushoverUser, nodeName;
+bool fleetAggregator = false;
+bool adaptivePump = false;
+uint32_t peakHours = 0;
 int sensorLowPin, sensorHighPin, sensorMidPin, relayPin, manualButtonPin;
 bool isConfigured = false;
 
 const char* apSSID = "ESP32-Setup";
 const char* apPASS = "12345678";
+const char* timeZone = "CET-1CEST,M3.5.0,M10.5.0/3"; // czas lokalny dla godzin taryfy
 
 // --- Watchdog ---
 hw_timer_t *watchdogTimer = NULL;
@@ -43,13 +58,55 @@ void loadConfig() {
         pass = preferences.getString("pass", "");
         pushoverToken = preferences.getString("pushtoken", "");
         pushoverUser = preferences.getString("pushuser", "");
+        nodeName = preferences.getString("nodeName", "");
+        fleetAggregator = preferences.getBool("aggregator", false);
+        adaptivePump = preferences.getBool("adaptive", false);
+        peakHours = preferences.getUInt("peakHours", 0);
     }
     preferences.end();
 }
 
+// --- Zadania okresowe ---
+const int statusLedPin = 2; // Można przenieść do konfiguracji
+
+void checkWifi(void*) {
+    bool previousState = systemState.wifiConnected;
+    systemState.wifiConnected = (WiFi.status() == WL_CONNECTED);
+    if (systemState.wifiConnected && !previousState) {
+        // Także po starcie bez sieci (tryb AP) - inaczej taryfa nie dostałaby czasu
+        configTzTime(timeZone, "pool.ntp.org");
+        systemState.addEvent("Ponownie połączono z WiFi");
+        notifier.sendPushover("Urządzenie ponownie online");
+    } else if (!systemState.wifiConnected && previousState) {
+        systemState.addEvent("Utracono połączenie WiFi");
+    }
+}
+
+void updateStatusLed(void*) {
+    static bool ledState = LOW;
+    if (!systemState.wifiConnected) {
+        digitalWrite(statusLedPin, HIGH);
+    } else {
+        ledState = !ledState;
+        digitalWrite(statusLedPin, ledState);
+    }
+}
+
+void registerTasks() {
+    scheduler.every(50, [](void*) { pumpController.loop(); });
+    scheduler.every(20, [](void*) { webInterface.handleClient(); });
+    scheduler.every(50, [](void*) { waterMQTT.loop(); });
+    scheduler.every(10000, [](void*) { waterMQTT.sendData(); });
+    scheduler.every(10000, [](void*) { heapMonitor.sample(); });
+    scheduler.every(60000, checkWifi);
+    scheduler.every(500, updateStatusLed);
+    scheduler.every(100, [](void*) { fleet.loop(); });
+}
+
 void setup() {
     Serial.begin(115200);
-    Serial.println("Rozpoczęcie działania...");
+    logger.begin(preferences);
+    logger.info(LOG_SYS, "Rozpoczęcie działania...");
 
     loadConfig();
 
@@ -60,17 +117,25 @@ void setup() {
     timerAlarmEnable(watchdogTimer);
 
     // Inicjalizacja modułów
+    pumpController.configurePolicy(adaptivePump, peakHours);
+#ifdef BOARD_PROFILE
+    pumpController.begin();
+#else
     pumpController.begin(sensorLowPin, sensorHighPin, sensorMidPin, relayPin, manualButtonPin);
+#endif
     notifier.begin(pushoverUser, pushoverToken);
     
     waterMQTT.begin(preferences);
-    waterMQTT.setPins(sensorLowPin, sensorHighPin, sensorMidPin, relayPin);
-    // Przekazujemy wskaźniki do zmiennych stanu w `systemState`
-    waterMQTT.setWaterStates(&systemState.pumpOn, &systemState.manualMode, &systemState.testMode);
+    waterMQTT.setPumpController(&pumpController);
+    // MQTT czyta migawki stanu publikowane przez zadanie sterujące
+    waterMQTT.setStateSource(&systemState.control);
+
+    scheduler.begin();
+    registerTasks();
 
     if (!isConfigured) {
         WiFi.softAP(apSSID, apPASS);
-        Serial.println("Tryb konfiguracyjny AP uruchomiony");
+        logger.info(LOG_SYS, "Tryb konfiguracyjny AP uruchomiony");
         webInterface.begin();
         return;
     }
@@ -85,59 +150,39 @@ void setup() {
 
     if (WiFi.status() == WL_CONNECTED) {
         systemState.wifiConnected = true;
-        Serial.println("\nPołączono z Wi-Fi. IP: " + WiFi.localIP().toString());
-        systemState.addEvent("Połączono z Wi-Fi: " + WiFi.localIP().toString());
-        notifier.sendPushover("Urządzenie online: " + WiFi.localIP().toString());
+        String ip = WiFi.localIP().toString();
+        Serial.println();
+        systemState.addEventf("Połączono z Wi-Fi: %s", ip.c_str());
+        configTzTime(timeZone, "pool.ntp.org");
+        char msg[64];
+        snprintf(msg, sizeof(msg), "Urządzenie online: %s", ip.c_str());
+        notifier.sendPushover(msg);
     } else {
         systemState.wifiConnected = false;
         WiFi.softAP("ESP32-WaterMonitor", "pompa123");
-        Serial.println("\nNie udało się połączyć z WiFi, uruchomiono AP");
+        Serial.println();
+        logger.warn(LOG_SYS, "Nie udało się połączyć z WiFi, uruchomiono AP");
         systemState.addEvent("Tryb offline - AP");
     }
 
-    // Inicjalizacja serwera WWW i mDNS
+    // Inicjalizacja serwera WWW i mDNS - każdy węzeł floty ma własną nazwę
     webInterface.begin();
-    if (MDNS.begin("esp32")) {
-        Serial.println("mDNS uruchomiony jako esp32.local");
+    char hostName[FLEET_NAME_LEN + 1];
+    Fleet::normalizeName(nodeName.c_str(), hostName, sizeof(hostName));
+    logger.setHostName(hostName);
+    if (MDNS.begin(hostName)) {
+        MDNS.addService("http", "tcp", 80);
+        logger.info(LOG_SYS, "mDNS uruchomiony jako %s.local", hostName);
     } else {
-        Serial.println("Błąd inicjalizacji mDNS!");
+        logger.error(LOG_SYS, "Błąd inicjalizacji mDNS!");
     }
+    fleet.begin(hostName, fleetAggregator);
+    waterMQTT.setNodeName(hostName);
 }
 
 void loop() {
     timerWrite(watchdogTimer, 0); // Reset watchdoga
 
-    // Pętle głównych modułów
-    pumpController.loop();
-    webInterface.handleClient();
-    waterMQTT.loop();
-
-    // Sprawdzanie połączenia WiFi
-    static unsigned long lastWifiCheck = 0;
-    if (millis() - lastWifiCheck > 60000) {
-        lastWifiCheck = millis();
-        bool previousState = systemState.wifiConnected;
-        systemState.wifiConnected = (WiFi.status() == WL_CONNECTED);
-        if (systemState.wifiConnected && !previousState) {
-            systemState.addEvent("Ponownie połączono z WiFi");
-            notifier.sendPushover("Urządzenie ponownie online");
-        } else if (!systemState.wifiConnected && previousState) {
-            systemState.addEvent("Utracono połączenie WiFi");
-        }
-    }
-
-    // Aktualizacja diody LED
-    // (tę logikę również można przenieść do osobnej małej klasy lub funkcji)
-    static unsigned long previousLedMillis = 0;
-    static bool ledState = LOW;
-    int statusLedPin = 2; // Można przenieść do konfiguracji
-    if (!systemState.wifiConnected) {
-        digitalWrite(statusLedPin, HIGH);
-    } else {
-        if (millis() - previousLedMillis >= 500) {
-            previousLedMillis = millis();
-            ledState = !ledState;
-            digitalWrite(statusLedPin, ledState);
-        }
-    }
+    // Wykonaj zadania z minionym terminem i uśpij CPU do następnego
+    scheduler.run();
 }
@@ -0,0 +1,190 @@
+#include "Fleet.h"
+#include <inttypes.h>
+
+static const IPAddress FLEET_GROUP(239, 255, 43, 21);
+static const uint16_t FLEET_PORT = 43210;
+static const uint8_t FLEET_VERSION = 1;
+
+static void putU32(uint8_t* p, uint32_t v) {
+    p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+}
+
+static uint32_t getU32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+Fleet::Fleet(SystemState& state) : systemState(state) {}
+
+uint32_t Fleet::localNodeId() {
+    // getEfuseMac() zwraca bajty MAC od najmłodszego; bajty 0..2 to prefiks
+    // producenta (wspólny dla płytek Espressif), więc ID budujemy z bajtów 2..5
+    return (uint32_t)(ESP.getEfuseMac() >> 16);
+}
+
+// Nazwa węzła i hosta mDNS: z konfiguracji (małe litery, cyfry, '-'),
+// a gdy pusta - zbiornik-xxxxxx z końcówki adresu MAC
+void Fleet::normalizeName(const char* configured, char* out, size_t size) {
+    size_t len = 0;
+    for (const char* p = configured; *p && len + 1 < size; p++) {
+        char c = tolower((unsigned char)*p);
+        out[len++] = isalnum((unsigned char)c) ? c : '-';
+    }
+    out[len] = '\0';
+    if (len > 0) return;
+
+    uint64_t mac = ESP.getEfuseMac();
+    // getEfuseMac() zwraca bajty MAC od najmłodszego - końcówka to bajty 3..5
+    snprintf(out, size, "zbiornik-%02x%02x%02x",
+             (unsigned)((mac >> 24) & 0xff), (unsigned)((mac >> 32) & 0xff), (unsigned)((mac >> 40) & 0xff));
+}
+
+void Fleet::begin(const char* name, bool isAggregator) {
+    strlcpy(nodeName, name, sizeof(nodeName));
+    aggregator = isAggregator;
+    nodeId = localNodeId();
+
+    // Tylko agregator dołącza do grupy; pozostałe węzły wyłącznie nadają
+    started = aggregator ? udp.beginMulticast(FLEET_GROUP, FLEET_PORT) : udp.begin(FLEET_PORT);
+    logger.info(LOG_FLEET, "%s jako %s", nodeName, aggregator ? "agregator" : "węzeł");
+}
+
+void Fleet::loop() {
+    if (!started || !systemState.wifiConnected) return;
+
+    if (aggregator) receive();
+
+    unsigned long now = millis();
+    bool changed = systemState.control.changedSince(sentVersion);
+    if (changed && now - lastChangeBeacon >= minChangeInterval) {
+        lastChangeBeacon = now;
+        sendBeacon(true);
+    } else if (now - lastBeacon >= heartbeatInterval) {
+        sendBeacon(false);
+    }
+}
+
+void Fleet::fillLocal(FleetNode& n, const ControlState& state) const {
+    n.nodeId = nodeId;
+    strlcpy(n.name, nodeName, sizeof(n.name));
+    n.seq = seq;
+    n.uptimeSec = millis() / 1000;
+    n.flags = (state.pumpOn ? FLEET_PUMP_ON : 0) | (state.manualMode ? FLEET_MANUAL : 0) |
+              (state.testMode ? FLEET_TEST : 0) | (state.midSensorPresent ? FLEET_MID_PRESENT : 0);
+    n.waterLevel = state.waterLevel;
+    n.rawInputs = state.rawInputs;
+}
+
+void Fleet::sendBeacon(bool change) {
+    ControlState state;
+    sentVersion = systemState.control.read(state);
+    lastBeacon = millis();
+    seq++;
+
+    FleetNode local;
+    fillLocal(local, state);
+    if (change) local.flags |= FLEET_CHANGE;
+    local.ip = (uint32_t)WiFi.localIP();
+
+    if (aggregator) update(local); // własny stan bez podróży przez sieć
+
+    uint8_t buf[FLEET_BEACON_SIZE];
+    size_t len = encode(local, buf);
+    if (udp.beginPacket(FLEET_GROUP, FLEET_PORT)) {
+        udp.write(buf, len);
+        udp.endPacket();
+    }
+}
+
+void Fleet::receive() {
+    uint8_t buf[FLEET_BEACON_SIZE];
+    // Ograniczenie liczby pakietów na wywołanie, by nie blokować pętli
+    for (int i = 0; i < 16 && udp.parsePacket() > 0; i++) {
+        int len = udp.read(buf, sizeof(buf));
+        FleetNode beacon;
+        if (len < FLEET_BEACON_SIZE || !decode(buf, len, beacon)) {
+            rejected++;
+            continue;
+        }
+        if (beacon.nodeId == nodeId) continue; // własny pakiet z pętli zwrotnej multicastu
+        beacon.ip = (uint32_t)udp.remoteIP();
+        received++;
+        update(beacon);
+    }
+}
+
+void Fleet::update(const FleetNode& beacon) {
+    FleetNode* slot = nullptr;
+    for (int i = 0; i < count; i++) {
+        if (nodes[i].nodeId == beacon.nodeId) {
+            slot = &nodes[i];
+            break;
+        }
+    }
+    if (!slot) {
+        if (count < FLEET_MAX_NODES) {
+            slot = &nodes[count++];
+        } else {
+            // Tabela pełna: zastąp najdawniej widziany węzeł offline
+            for (int i = 0; i < count; i++) {
+                if (!isOnline(nodes[i]) && (!slot || (long)(nodes[i].lastSeen - slot->lastSeen) < 0)) slot = &nodes[i];
+            }
+            if (!slot) {
+                tableFull++;
+                return;
+            }
+        }
+        *slot = FleetNode();
+    }
+    uint32_t beacons = slot->beacons;
+    *slot = beacon;
+    slot->lastSeen = millis();
+    slot->beacons = beacons + 1;
+}
+
+size_t Fleet::encode(const FleetNode& n, uint8_t* buf) {
+    memset(buf, 0, FLEET_BEACON_SIZE);
+    buf[0] = 'W';
+    buf[1] = 'M';
+    buf[2] = FLEET_VERSION;
+    buf[3] = n.flags;
+    putU32(buf + 4, n.nodeId);
+    putU32(buf + 8, n.seq);
+    putU32(buf + 12, n.uptimeSec);
+    buf[16] = n.waterLevel;
+    buf[17] = n.rawInputs;
+    memcpy(buf + 20, n.name, strnlen(n.name, FLEET_NAME_LEN));
+    return FLEET_BEACON_SIZE;
+}
+
+bool Fleet::decode(const uint8_t* buf, size_t len, FleetNode& n) {
+    if (len < FLEET_BEACON_SIZE || buf[0] != 'W' || buf[1] != 'M' || buf[2] != FLEET_VERSION) return false;
+    n.flags = buf[3];
+    n.nodeId = getU32(buf + 4);
+    n.seq = getU32(buf + 8);
+    n.uptimeSec = getU32(buf + 12);
+    n.waterLevel = buf[16] > 100 ? 100 : buf[16];
+    n.rawInputs = buf[17];
+    memcpy(n.name, buf + 20, FLEET_NAME_LEN);
+    n.name[FLEET_NAME_LEN] = '\0';
+    // Nazwa trafia do HTML/JSON - dopuszczamy tylko znaki nazwy hosta
+    for (char* p = n.name; *p; p++) {
+        if (!isalnum((unsigned char)*p) && *p != '-') *p = '_';
+    }
+    return true;
+}
+
+void Fleet::writeNodeJson(const FleetNode& n, TextBuffer& out) const {
+    out.appendf("{\"id\":\"%08" PRIx32 "\",\"name\":\"%s\",\"ip\":\"%u.%u.%u.%u\",\"online\":%s,\"ageSec\":%lu"
+                ",\"uptimeSec\":%" PRIu32 ",\"seq\":%" PRIu32 ",\"level\":%u,\"pump\":%s,\"mode\":\"%s\",\"inputs\":%u}",
+                n.nodeId, n.name,
+                (unsigned)(n.ip & 0xff), (unsigned)((n.ip >> 8) & 0xff), (unsigned)((n.ip >> 16) & 0xff), (unsigned)(n.ip >> 24),
+                isOnline(n) ? "true" : "false", (millis() - n.lastSeen) / 1000,
+                n.uptimeSec, n.seq, n.waterLevel, (n.flags & FLEET_PUMP_ON) ? "true" : "false",
+                (n.flags & FLEET_TEST) ? "test" : ((n.flags & FLEET_MANUAL) ? "manual" : "auto"), n.rawInputs);
+}
+
+void Fleet::writeJson(TextBuffer& out) const {
+    out.appendf("{\"node\":\"%s\",\"aggregator\":%s,\"beaconsSent\":%" PRIu32 ",\"nodes\":%d"
+                ",\"received\":%" PRIu32 ",\"rejected\":%" PRIu32 ",\"tableFull\":%" PRIu32 "}",
+                nodeName, aggregator ? "true" : "false", seq, count, received, rejected, tableFull);
+}
@@ -0,0 +1,87 @@
+#ifndef FLEET_H
+#define FLEET_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include "SystemState.h"
+#include "TextBuffer.h"
+
+#define FLEET_MAX_NODES 64
+#define FLEET_NAME_LEN 16
+#define FLEET_BEACON_SIZE 36
+
+// Flagi w bajcie 3 beaconu
+enum FleetFlags : uint8_t {
+    FLEET_PUMP_ON = 0x01,
+    FLEET_MANUAL = 0x02,
+    FLEET_TEST = 0x04,
+    FLEET_MID_PRESENT = 0x08,
+    FLEET_CHANGE = 0x10 // wysłany po zmianie stanu (0 = heartbeat)
+};
+
+struct FleetNode {
+    uint32_t nodeId = 0;
+    char name[FLEET_NAME_LEN + 1] = "";
+    uint32_t ip = 0;
+    uint32_t seq = 0;
+    uint32_t uptimeSec = 0;
+    uint8_t flags = 0;
+    uint8_t waterLevel = 0;
+    uint8_t rawInputs = 0;
+    unsigned long lastSeen = 0;
+    uint32_t beacons = 0;
+};
+
+// Tryb floty: każdy węzeł rozsyła multicastem UDP zwięzły beacon stanu
+// (po zmianie i co heartbeatInterval), a wybrany węzeł-agregator zbiera
+// je w tabeli floty udostępnianej jako /fleet i /api/fleet.
+class Fleet {
+public:
+    Fleet(SystemState& state);
+    void begin(const char* nodeName, bool aggregator);
+    void loop();
+
+    bool isAggregator() const { return aggregator; }
+    const char* getNodeName() const { return nodeName; }
+    int nodeCount() const { return count; }
+    const FleetNode& node(int i) const { return nodes[i]; }
+    bool isOnline(const FleetNode& n) const { return millis() - n.lastSeen < offlineTimeout; }
+    void writeNodeJson(const FleetNode& n, TextBuffer& out) const;
+    void writeJson(TextBuffer& out) const;
+
+    // Kodowanie/dekodowanie beaconu (little-endian, FLEET_BEACON_SIZE bajtów)
+    static size_t encode(const FleetNode& n, uint8_t* buf);
+    static bool decode(const uint8_t* buf, size_t len, FleetNode& n);
+    static uint32_t localNodeId();
+    static void normalizeName(const char* configured, char* out, size_t size);
+
+private:
+    void sendBeacon(bool change);
+    void receive();
+    void update(const FleetNode& beacon);
+    void fillLocal(FleetNode& n, const ControlState& state) const;
+
+    SystemState& systemState;
+    WiFiUDP udp;
+    bool started = false;
+    bool aggregator = false;
+    char nodeName[FLEET_NAME_LEN + 1] = "";
+    uint32_t nodeId = 0;
+    uint32_t seq = 0;
+    uint32_t sentVersion = UINT32_MAX;
+    unsigned long lastBeacon = 0;
+    unsigned long lastChangeBeacon = 0;
+
+    const unsigned long heartbeatInterval = 30000;
+    const unsigned long minChangeInterval = 1000;
+    const unsigned long offlineTimeout = 95000; // ~3 heartbeaty
+
+    FleetNode nodes[FLEET_MAX_NODES];
+    int count = 0;
+    uint32_t received = 0;
+    uint32_t rejected = 0;
+    uint32_t tableFull = 0;
+};
+
+#endif
@@ -0,0 +1,46 @@
+#include "HeapMonitor.h"
+#include <inttypes.h>
+
+HeapMonitor heapMonitor;
+
+const char* HeapMonitor::subsystemName(HeapSubsystem subsystem) {
+    switch (subsystem) {
+        case HEAP_WEB: return "web";
+        case HEAP_MQTT: return "mqtt";
+        case HEAP_NOTIFIER: return "notifier";
+        case HEAP_EVENTS: return "events";
+        default: return "?";
+    }
+}
+
+void HeapMonitor::sample() {
+    freeHeap = ESP.getFreeHeap();
+    minFreeHeap = ESP.getMinFreeHeap();
+    largestFreeBlock = ESP.getMaxAllocHeap();
+    if (largestFreeBlock < minLargestFreeBlock) minLargestFreeBlock = largestFreeBlock;
+}
+
+void HeapMonitor::record(HeapSubsystem subsystem, uint32_t freeBefore, uint32_t freeAfter) {
+    if (paused) return;
+    HeapSubsystemStats& s = stats[subsystem];
+    s.calls++;
+    if (freeAfter < freeBefore) s.retainingCalls++;
+    s.netBytes += (int32_t)(freeBefore - freeAfter);
+    if (freeAfter < s.minFreeHeap) s.minFreeHeap = freeAfter;
+}
+
+void HeapMonitor::writeJson(TextBuffer& out) const {
+    out.appendf("{\"free\":%" PRIu32 ",\"minFree\":%" PRIu32 ",\"largestBlock\":%" PRIu32
+                ",\"minLargestBlock\":%" PRIu32 ",\"subsystems\":{",
+                freeHeap, minFreeHeap, largestFreeBlock,
+                minLargestFreeBlock == UINT32_MAX ? largestFreeBlock : minLargestFreeBlock);
+    for (int i = 0; i < HEAP_SUBSYSTEM_COUNT; i++) {
+        const HeapSubsystemStats& s = stats[i];
+        out.appendf("%s\"%s\":{\"calls\":%" PRIu32 ",\"retaining\":%" PRIu32
+                ",\"netBytes\":%" PRId32 ",\"minFree\":%" PRIu32 "}",
+                    i ? "," : "", subsystemName((HeapSubsystem)i),
+                    s.calls, s.retainingCalls, s.netBytes,
+                    s.minFreeHeap == UINT32_MAX ? 0 : s.minFreeHeap);
+    }
+    out.append("}}");
+}
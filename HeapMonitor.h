@@ -0,0 +1,65 @@
+#ifndef HEAP_MONITOR_H
+#define HEAP_MONITOR_H
+
+#include <Arduino.h>
+#include "TextBuffer.h"
+
+// Podsystemy, dla których zliczamy zużycie sterty
+enum HeapSubsystem {
+    HEAP_WEB = 0,
+    HEAP_MQTT,
+    HEAP_NOTIFIER,
+    HEAP_EVENTS,
+    HEAP_SUBSYSTEM_COUNT
+};
+
+struct HeapSubsystemStats {
+    uint32_t calls = 0;
+    uint32_t retainingCalls = 0; // wywołania, po których sterty ubyło
+    int32_t netBytes = 0;        // suma (wejście - wyjście) wolnej sterty
+    uint32_t minFreeHeap = UINT32_MAX;
+};
+
+// Telemetria sterty: wolna pamięć, minimum od startu, największy wolny blok
+// (miara fragmentacji) i bilans per podsystem. Rdzeń Arduino nie udostępnia
+// haków malloc, więc per podsystem mierzymy różnicę wolnej sterty na wejściu
+// i wyjściu z gorącej ścieżki (HeapScope). Liczbę alokacji na wywołanie
+// sprawdza na hoście tools/heap_check.
+class HeapMonitor {
+public:
+    void sample();
+    void record(HeapSubsystem subsystem, uint32_t freeBefore, uint32_t freeAfter);
+    // Wstrzymuje bilans podsystemów, np. na czas /bench (sztuczne wywołania)
+    void setPaused(bool value) { paused = value; }
+    void writeJson(TextBuffer& out) const;
+
+    uint32_t getFreeHeap() const { return freeHeap; }
+    uint32_t getMinFreeHeap() const { return minFreeHeap; }
+    uint32_t getLargestFreeBlock() const { return largestFreeBlock; }
+    const HeapSubsystemStats& getStats(HeapSubsystem subsystem) const { return stats[subsystem]; }
+
+    static const char* subsystemName(HeapSubsystem subsystem);
+
+private:
+    uint32_t freeHeap = 0;
+    uint32_t minFreeHeap = 0;
+    uint32_t largestFreeBlock = 0;
+    uint32_t minLargestFreeBlock = UINT32_MAX;
+    bool paused = false;
+    HeapSubsystemStats stats[HEAP_SUBSYSTEM_COUNT];
+};
+
+extern HeapMonitor heapMonitor;
+
+// RAII: mierzy bilans sterty jednego wywołania gorącej ścieżki
+class HeapScope {
+public:
+    explicit HeapScope(HeapSubsystem subsystem) : subsystem(subsystem), freeBefore(ESP.getFreeHeap()) {}
+    ~HeapScope() { heapMonitor.record(subsystem, freeBefore, ESP.getFreeHeap()); }
+
+private:
+    HeapSubsystem subsystem;
+    uint32_t freeBefore;
+};
+
+#endif
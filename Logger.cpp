@@ -0,0 +1,203 @@
+#include "Logger.h"
+#include <WiFi.h>
+#include <inttypes.h>
+
+Logger logger;
+
+static const uint8_t SYSLOG_FACILITY = 16; // local0
+static const uint32_t DRAIN_PERIOD_MS = 20;
+
+Logger::Logger() {
+    for (uint32_t i = 0; i < LOG_RING_SIZE; i++) ring[i].sequence.store(i, std::memory_order_relaxed);
+    sinkLevels[LOG_SINK_SERIAL].store(LOG_INFO);
+    sinkLevels[LOG_SINK_SYSLOG].store(LOG_INFO);
+    sinkLevels[LOG_SINK_MQTT].store(LOG_OFF);
+}
+
+void Logger::begin(Preferences& prefs) {
+    loadConfig(prefs);
+    mqttQueue = xQueueCreate(8, sizeof(LogRecord));
+    xTaskCreate(drainTaskEntry, "log_drain", 4096, this, tskIDLE_PRIORITY + 1, &drainTaskHandle);
+}
+
+const char* Logger::moduleName(LogModule module) {
+    switch (module) {
+        case LOG_SYS: return "sys";
+        case LOG_EVENT: return "event";
+        case LOG_PUMP: return "pump";
+        case LOG_MQTT: return "mqtt";
+        case LOG_WEB: return "web";
+        case LOG_NOTIFY: return "notify";
+        case LOG_FLEET: return "fleet";
+        default: return "?";
+    }
+}
+
+char Logger::levelChar(LogLevel level) {
+    switch (level) {
+        case LOG_ERROR: return 'E';
+        case LOG_WARN: return 'W';
+        case LOG_INFO: return 'I';
+        default: return 'D';
+    }
+}
+
+void Logger::error(LogModule module, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    write(LOG_ERROR, module, fmt, args);
+    va_end(args);
+}
+
+void Logger::warn(LogModule module, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    write(LOG_WARN, module, fmt, args);
+    va_end(args);
+}
+
+void Logger::info(LogModule module, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    write(LOG_INFO, module, fmt, args);
+    va_end(args);
+}
+
+void Logger::debug(LogModule module, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    write(LOG_DEBUG, module, fmt, args);
+    va_end(args);
+}
+
+// Producent: rezerwuje slot przez CAS na head i formatuje wpis bezpośrednio w nim
+void Logger::write(LogLevel level, LogModule module, const char* fmt, va_list args) {
+    // Wpis, którego nie przyjmie żadne ujście, nie zajmuje miejsca w pierścieniu
+    bool wanted = false;
+    for (int i = 0; i < LOG_SINK_COUNT; i++) wanted |= accepts((LogSink)i, level);
+    if (!wanted) return;
+
+    uint32_t pos = head.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;) {
+        cell = &ring[pos & (LOG_RING_SIZE - 1)];
+        uint32_t seq = cell->sequence.load(std::memory_order_acquire);
+        int32_t diff = (int32_t)(seq - pos);
+        if (diff == 0) {
+            if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            dropped.fetch_add(1, std::memory_order_relaxed); // pierścień pełny
+            return;
+        } else {
+            pos = head.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->record.timestamp = millis();
+    cell->record.level = level;
+    cell->record.module = module;
+    vsnprintf(cell->record.text, LOG_TEXT_LEN, fmt, args);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    written.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Odbiorca (tylko zadanie opróżniające)
+bool Logger::dequeue(LogRecord& record) {
+    Cell& cell = ring[tail & (LOG_RING_SIZE - 1)];
+    if (cell.sequence.load(std::memory_order_acquire) != tail + 1) return false;
+    record = cell.record;
+    cell.sequence.store(tail + LOG_RING_SIZE, std::memory_order_release);
+    tail++;
+    return true;
+}
+
+void Logger::drainTaskEntry(void* arg) {
+    static_cast<Logger*>(arg)->drainTask();
+}
+
+void Logger::drainTask() {
+    for (;;) {
+        drain();
+        vTaskDelay(pdMS_TO_TICKS(DRAIN_PERIOD_MS));
+    }
+}
+
+void Logger::drain() {
+    LogRecord record;
+    while (dequeue(record)) {
+        if (accepts(LOG_SINK_SERIAL, record.level)) toSerial(record);
+        if (accepts(LOG_SINK_SYSLOG, record.level)) toSyslog(record);
+        if (accepts(LOG_SINK_MQTT, record.level) && mqttQueue) {
+            if (xQueueSend(mqttQueue, &record, 0) == pdTRUE) sinkSent[LOG_SINK_MQTT]++;
+            else mqttDropped++;
+        }
+    }
+}
+
+void Logger::toSerial(const LogRecord& record) {
+    TextBuffer line(lineBuffer, sizeof(lineBuffer));
+    line.appendf("[%7lu.%03lu] %c %s: %s\n", (unsigned long)(record.timestamp / 1000), (unsigned long)(record.timestamp % 1000),
+                 levelChar(record.level), moduleName(record.module), record.text);
+    Serial.write((const uint8_t*)line.c_str(), line.length());
+    sinkSent[LOG_SINK_SERIAL]++;
+}
+
+// RFC 5424: <PRI>1 TIMESTAMP HOSTNAME APP-NAME PROCID MSGID SD BOM MSG
+// Urządzenie nie ma zegara ściennego, więc TIMESTAMP to "-" (nadaje odbiorca).
+void Logger::toSyslog(const LogRecord& record) {
+    uint32_t addr = syslogAddr.load(std::memory_order_relaxed);
+    if (addr == 0 || WiFi.status() != WL_CONNECTED) return;
+
+    TextBuffer line(lineBuffer, sizeof(lineBuffer));
+    line.appendf("<%u>1 - %s watermonitor - %s - \xEF\xBB\xBF%s",
+                 SYSLOG_FACILITY * 8 + record.level, hostName, moduleName(record.module), record.text);
+    if (syslogUdp.beginPacket(IPAddress(addr), syslogPort.load(std::memory_order_relaxed))) {
+        syslogUdp.write((const uint8_t*)line.c_str(), line.length());
+        if (syslogUdp.endPacket()) sinkSent[LOG_SINK_SYSLOG]++;
+    }
+}
+
+bool Logger::nextMqttRecord(LogRecord& record) {
+    return mqttQueue && xQueueReceive(mqttQueue, &record, 0) == pdTRUE;
+}
+
+void Logger::setSinkLevel(LogSink sink, LogLevel level) {
+    sinkLevels[sink].store(level, std::memory_order_relaxed);
+}
+
+void Logger::setSyslogServer(const IPAddress& ip, uint16_t port) {
+    syslogPort.store(port, std::memory_order_relaxed);
+    syslogAddr.store((uint32_t)ip, std::memory_order_relaxed);
+}
+
+void Logger::loadConfig(Preferences& prefs) {
+    prefs.begin("log", true);
+    syslogAddr.store(prefs.getUInt("ip", 0));
+    syslogPort.store(prefs.getInt("port", 514));
+    sinkLevels[LOG_SINK_SERIAL].store((LogLevel)prefs.getUChar("serial", LOG_INFO));
+    sinkLevels[LOG_SINK_SYSLOG].store((LogLevel)prefs.getUChar("syslog", LOG_INFO));
+    sinkLevels[LOG_SINK_MQTT].store((LogLevel)prefs.getUChar("mqtt", LOG_OFF));
+    prefs.end();
+}
+
+void Logger::saveConfig(Preferences& prefs) {
+    prefs.begin("log", false);
+    prefs.putUInt("ip", syslogAddr.load());
+    prefs.putInt("port", syslogPort.load());
+    prefs.putUChar("serial", getSinkLevel(LOG_SINK_SERIAL));
+    prefs.putUChar("syslog", getSinkLevel(LOG_SINK_SYSLOG));
+    prefs.putUChar("mqtt", getSinkLevel(LOG_SINK_MQTT));
+    prefs.end();
+}
+
+void Logger::setHostName(const char* name) {
+    strlcpy(hostName, name, sizeof(hostName));
+}
+
+void Logger::writeJson(TextBuffer& out) const {
+    out.appendf("{\"written\":%" PRIu32 ",\"dropped\":%" PRIu32 ",\"serial\":%" PRIu32 ",\"syslog\":%" PRIu32
+                ",\"mqttQueued\":%" PRIu32 ",\"mqttDropped\":%" PRIu32 ",\"levels\":[%u,%u,%u]}",
+                written.load(), dropped.load(), sinkSent[LOG_SINK_SERIAL], sinkSent[LOG_SINK_SYSLOG],
+                sinkSent[LOG_SINK_MQTT], mqttDropped,
+                getSinkLevel(LOG_SINK_SERIAL), getSinkLevel(LOG_SINK_SYSLOG), getSinkLevel(LOG_SINK_MQTT));
+}
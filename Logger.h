@@ -0,0 +1,126 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <stdarg.h>
+#include <WiFiUdp.h>
+#include <Preferences.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include "TextBuffer.h"
+
+// Poziomy zgodne z ważnością syslog (RFC 5424)
+enum LogLevel : uint8_t {
+    LOG_ERROR = 3,
+    LOG_WARN = 4,
+    LOG_INFO = 6,
+    LOG_DEBUG = 7,
+    LOG_OFF = 0xff // tylko jako próg ujścia: nic nie przechodzi
+};
+
+enum LogModule : uint8_t {
+    LOG_SYS,
+    LOG_EVENT,
+    LOG_PUMP,
+    LOG_MQTT,
+    LOG_WEB,
+    LOG_NOTIFY,
+    LOG_FLEET,
+    LOG_MODULE_COUNT
+};
+
+enum LogSink : uint8_t {
+    LOG_SINK_SERIAL,
+    LOG_SINK_SYSLOG,
+    LOG_SINK_MQTT,
+    LOG_SINK_COUNT
+};
+
+#define LOG_TEXT_LEN 96
+#define LOG_RING_SIZE 32 // potęga dwójki
+
+struct LogRecord {
+    uint32_t timestamp; // millis()
+    LogLevel level;
+    LogModule module;
+    char text[LOG_TEXT_LEN];
+};
+
+// Strukturalne logowanie bez blokowania wywołującego: wpis formatowany jest
+// wprost do slotu pierścienia bez blokad (wielu producentów, jeden odbiorca),
+// a osobne zadanie o niskim priorytecie rozsyła go do Serial, syslog UDP
+// (RFC 5424) i - przez kolejkę odbieraną w loop() - do tematu MQTT.
+// Pełny pierścień oznacza odrzucenie wpisu i zwiększenie licznika, nigdy czekanie.
+class Logger {
+public:
+    Logger();
+    void begin(Preferences& prefs);
+
+    __attribute__((format(printf, 3, 4))) void error(LogModule module, const char* fmt, ...);
+    __attribute__((format(printf, 3, 4))) void warn(LogModule module, const char* fmt, ...);
+    __attribute__((format(printf, 3, 4))) void info(LogModule module, const char* fmt, ...);
+    __attribute__((format(printf, 3, 4))) void debug(LogModule module, const char* fmt, ...);
+    void write(LogLevel level, LogModule module, const char* fmt, va_list args);
+
+    // Konfiguracja w czasie działania
+    void setSinkLevel(LogSink sink, LogLevel level);
+    LogLevel getSinkLevel(LogSink sink) const { return sinkLevels[sink].load(std::memory_order_relaxed); }
+    void setSyslogServer(const IPAddress& ip, uint16_t port);
+    IPAddress getSyslogServer() const { return IPAddress(syslogAddr.load(std::memory_order_relaxed)); }
+    uint16_t getSyslogPort() const { return syslogPort.load(std::memory_order_relaxed); }
+    void setHostName(const char* name); // raz, w setup()
+    void saveConfig(Preferences& prefs);
+
+    // Jeden przebieg opróżniania pierścienia do ujść. Woła go zadanie log_drain;
+    // bez tego zadania (narzędzia hosta) - wywołujący, zawsze z jednego wątku.
+    void drain();
+
+    // Ujście MQTT: rekordy odbiera wątek loop() (PubSubClient nie jest wielowątkowy)
+    bool nextMqttRecord(LogRecord& record);
+
+    void writeJson(TextBuffer& out) const;
+    static const char* moduleName(LogModule module);
+    static char levelChar(LogLevel level);
+
+private:
+    struct Cell {
+        std::atomic<uint32_t> sequence;
+        LogRecord record;
+    };
+
+    static void drainTaskEntry(void* arg);
+    void drainTask();
+    bool dequeue(LogRecord& record);
+    bool accepts(LogSink sink, LogLevel level) const {
+        LogLevel threshold = getSinkLevel(sink);
+        return threshold != LOG_OFF && level <= threshold;
+    }
+    void toSerial(const LogRecord& record);
+    void toSyslog(const LogRecord& record);
+    void loadConfig(Preferences& prefs);
+
+    Cell ring[LOG_RING_SIZE];
+    std::atomic<uint32_t> head{0};
+    uint32_t tail = 0;
+
+    std::atomic<LogLevel> sinkLevels[LOG_SINK_COUNT];
+    TaskHandle_t drainTaskHandle = nullptr;
+    QueueHandle_t mqttQueue = nullptr;
+
+    WiFiUDP syslogUdp;
+    std::atomic<uint32_t> syslogAddr{0}; // 0 = syslog wyłączony
+    std::atomic<uint16_t> syslogPort{514};
+    char hostName[32] = "-";
+    char lineBuffer[LOG_TEXT_LEN + 96];
+
+    std::atomic<uint32_t> written{0};
+    std::atomic<uint32_t> dropped{0};
+    uint32_t sinkSent[LOG_SINK_COUNT] = {};
+    uint32_t mqttDropped = 0;
+};
+
+extern Logger logger;
+
+#endif
@@ -7,20 +7,22 @@ void Notifier::begin(String user, String token) {
     pushoverToken = token;
 }
 
-void Notifier::sendPushover(String msg) {
+void Notifier::sendPushover(const char* msg) {
+    HeapScope scope(HEAP_NOTIFIER);
+
     // Nie wysyłaj tego samego komunikatu częściej niż co 30 sekund
-    if (msg == lastMessage && millis() - lastSendTime < 30000) {
-        Serial.println("[Pushover] Pominięto duplikat wiadomości: " + msg);
+    if (strcmp(msg, lastMessage) == 0 && millis() - lastSendTime < 30000) {
+        logger.debug(LOG_NOTIFY, "Pominięto duplikat wiadomości: %s", msg);
         return;
     }
 
-    Serial.println("[Pushover] Próba wysłania: " + msg);
+    logger.debug(LOG_NOTIFY, "Próba wysłania: %s", msg);
     if (!systemState.wifiConnected) {
-        Serial.println("[Pushover] Błąd: Brak połączenia WiFi");
+        logger.warn(LOG_NOTIFY, "Brak połączenia WiFi");
         return;
     }
     if (pushoverToken == "" || pushoverUser == "") {
-        Serial.println("[Pushover] Błąd: Brak tokenu lub użytkownika");
+        logger.warn(LOG_NOTIFY, "Brak tokenu lub użytkownika");
         return;
     }
 
@@ -30,50 +32,27 @@ void Notifier::sendPushover(String msg) {
     client.setTimeout(10000);
     https.setTimeout(10000);
 
-    String url = "https://api.pushover.net/1/messages.json";
+    // HTTPClient przyjmuje String - stałe tworzone raz, nie przy każdej wysyłce
+    static const String url("https://api.pushover.net/1/messages.json");
+    static const String contentType("Content-Type"), formEncoded("application/x-www-form-urlencoded");
     if (https.begin(client, url)) {
-        https.addHeader("Content-Type", "application/x-www-form-urlencoded");
-        String postData = "token=" + pushoverToken +
-                          "&user=" + pushoverUser +
-                          "&message=" + urlEncode(msg) +
-                          "&title=Zbiornik z wodą";
-        
-        int httpCode = https.POST(postData);
+        https.addHeader(contentType, formEncoded);
+        TextBuffer postData(postBuffer, sizeof(postBuffer));
+        postData.append("token=").append(pushoverToken.c_str())
+                .append("&user=").append(pushoverUser.c_str())
+                .append("&message=").appendUrlEncoded(msg)
+                .append("&title=Zbiornik z wodą");
+
+        int httpCode = https.POST((uint8_t*)postData.c_str(), postData.length());
         if (httpCode == HTTP_CODE_OK) {
-            Serial.println("[Pushover] Wysłano pomyślnie!");
-            lastMessage = msg;
+            logger.info(LOG_NOTIFY, "Wysłano: %s", msg);
+            strlcpy(lastMessage, msg, sizeof(lastMessage));
             lastSendTime = millis();
         } else {
-            Serial.println("[Pushover] Błąd wysyłania! HTTP Code: " + String(httpCode));
-            Serial.println(https.getString());
+            logger.error(LOG_NOTIFY, "Błąd wysyłania, HTTP %d: %s", httpCode, https.getString().c_str());
         }
         https.end();
     } else {
-        Serial.println("[Pushover] Błąd początkowania połączenia");
-    }
-}
-
-String Notifier::urlEncode(String str) {
-    String encodedString = "";
-    char c;
-    char code0;
-    char code1;
-    for (unsigned int i = 0; i < str.length(); i++) {
-        c = str.charAt(i);
-        if (c == ' ') {
-            encodedString += '+';
-        } else if (isalnum(c)) {
-            encodedString += c;
-        } else {
-            code1 = (c & 0xf) + '0';
-            if ((c & 0xf) > 9) code1 = (c & 0xf) - 10 + 'A';
-            c = (c >> 4) & 0xf;
-            code0 = c + '0';
-            if (c > 9) code0 = c - 10 + 'A';
-            encodedString += '%';
-            encodedString += code0;
-            encodedString += code1;
-        }
+        logger.error(LOG_NOTIFY, "Błąd rozpoczęcia połączenia");
     }
-    return encodedString;
 }
@@ -5,19 +5,20 @@
 #include <WiFiClientSecure.h>
 #include <HTTPClient.h>
 #include "SystemState.h"
+#include "TextBuffer.h"
 
 class Notifier {
 public:
     Notifier(SystemState& state);
     void begin(String user, String token);
-    void sendPushover(String msg);
+    void sendPushover(const char* msg);
 
 private:
-    String urlEncode(String str);
     SystemState& systemState;
     String pushoverUser;
     String pushoverToken;
-    String lastMessage;
+    char lastMessage[128] = "";
+    char postBuffer[768];
     unsigned long lastSendTime = 0;
 };
 
@@ -1,4 +1,32 @@
 #include "PumpController.h"
+#include <inttypes.h>
+#include <time.h>
+
+// Teksty komunikatów: zdarzenie w historii oraz (opcjonalnie) Pushover
+struct NoticeText {
+    const char* event;
+    const char* pushover;
+};
+
+static const NoticeText NOTICE_TEXTS[NOTICE_COUNT] = {
+    { "Automatyczne wyłączenie pompy (górny czujnik)", "Pompa została automatycznie wyłączona - zbiornik pełny" },
+    { "Automatyczne włączenie pompy (brak wody)", "Pompa została automatycznie włączona - niski poziom wody" },
+    { "Automatyczne wyłączenie trybu manualnego po 30 minutach", nullptr },
+    { "Osiągnięto limit przełączeń pompy (4/min)", "Osiągnięto limit przełączeń pompy (4/min) - bezpiecznik" },
+    { "Zbyt częste przełączanie pompy - bezpiecznik", "Zbyt częste przełączanie pompy - bezpiecznik" },
+    { "Ręczne sterowanie POMPA (WWW) – WŁĄCZONA", nullptr },
+    { "Ręczne sterowanie POMPA (WWW) – WYŁĄCZONA", nullptr },
+    { "Przycisk BOOT POMPA – WŁĄCZONA", "Przycisk BOOT POMPA: włączono" },
+    { "Przycisk BOOT POMPA – WYŁĄCZONA", "Przycisk BOOT POMPA: wyłączono" },
+    { "Włączono tryb testowy", nullptr },
+    { "Wyłączono tryb testowy", nullptr },
+    { "Przywrócono sterowanie automatyczne", nullptr },
+    { "Wcześniejsze napełnianie przed szczytem taryfy", nullptr },
+    { "Zatrzymanie pompy na środkowym czujniku (szczyt taryfy)", nullptr },
+};
+
+// Górne granice kubełków histogramu opóźnień [us]; ostatni zbiera resztę
+static const uint32_t LATENCY_BOUNDS_US[LATENCY_BUCKETS - 1] = { 50, 100, 250, 500, 1000, 2500, 5000 };
 
 PumpController::PumpController(SystemState& state, Notifier& notifier)
     : systemState(state), notifier(notifier) {}
@@ -18,102 +46,341 @@ void PumpController::begin(int lowPin, int highPin, int midPin, int relayPin, in
 
     if (manualButtonPin != -1) {
         pinMode(manualButtonPin, INPUT_PULLUP);
-        lastButtonState = digitalRead(manualButtonPin);
+    }
+    state.midSensorPresent = (sensorMidPin != -1);
+
+    commandQueue = xQueueCreate(8, sizeof(PumpCommand));
+    noticeQueue = xQueueCreate(16, sizeof(PumpNotice));
+    systemState.control.publish(state);
+
+    if (xTaskCreate(controlTaskEntry, "pump_ctrl", 4096, this, controlTaskPriority, &controlTaskHandle) != pdPASS) {
+        logger.error(LOG_PUMP, "Nie udało się uruchomić zadania sterującego");
     }
 }
 
+// --- Strona pętli głównej ---
+
+// Zamienia komunikaty zadania sterującego na zdarzenia/Pushover.
+// Wywoływane wyłącznie z wątku loop().
 void PumpController::loop() {
-    readSensors();
-    if (manualButtonPin != -1) {
-        handleManualButton();
+    PumpNotice notice;
+    while (xQueueReceive(noticeQueue, &notice, 0) == pdTRUE) {
+        const NoticeText& text = NOTICE_TEXTS[notice];
+        systemState.addEvent(text.event);
+        if (text.pushover) notifier.sendPushover(text.pushover);
+    }
+}
+
+bool PumpController::sendCommand(PumpCommandType type, PumpCommandSource source, bool value) {
+    PumpCommand cmd = { type, source, value };
+    if (commandQueue == nullptr || xQueueSend(commandQueue, &cmd, 0) != pdTRUE) {
+        commandsDropped++;
+        return false;
     }
+    return true;
+}
+
+void PumpController::writeJson(TextBuffer& out) const {
+    PumpTaskStats s;
+    publishedStats.read(s);
+    uint32_t avgCycle = s.cycles ? (uint32_t)(s.cycleCpuCycles / s.cycles) : 0;
+    out.appendf("{\"profile\":\"%s\",\"periodMs\":%" PRIu32 ",\"cycles\":%" PRIu32 ",\"avgCycleCpu\":%" PRIu32
+                ",\"deadlineMisses\":%" PRIu32 ",\"maxLatencyUs\":%" PRIu32
+                ",\"commandsDropped\":%" PRIu32 ",\"noticesDropped\":%" PRIu32,
+                profileName(), controlPeriodMs, s.cycles, avgCycle, s.deadlineMisses, s.maxLatencyUs,
+                commandsDropped, s.noticesDropped);
+    if (benchStaticCycles) {
+        out.appendf(",\"inputReadCpu\":{\"runtime\":%" PRIu32 ",\"board\":%" PRIu32 "}",
+                    benchRuntimeCycles, benchStaticCycles);
+    }
+    out.append(",\"latencyUs\":{");
+    for (int i = 0; i < LATENCY_BUCKETS; i++) {
+        if (i < LATENCY_BUCKETS - 1) {
+            out.appendf("%s\"<%" PRIu32 "\":%" PRIu32, i ? "," : "", LATENCY_BOUNDS_US[i], s.latencyHistogram[i]);
+        } else {
+            out.appendf(",\"inf\":%" PRIu32, s.latencyHistogram[i]);
+        }
+    }
+    out.append("}}");
+}
+
+static void writeDayJson(TextBuffer& out, const PumpDayStats& day) {
+    out.appendf("{\"cycles\":%" PRIu32 ",\"runS\":%" PRIu32 ",\"peakRunS\":%" PRIu32 ",\"refusals\":%" PRIu32 "}",
+                day.cycles, day.runMs / 1000, day.peakRunMs / 1000, day.refusals);
+}
+
+void PumpController::writeCyclesJson(TextBuffer& out) const {
+    PumpTaskStats s;
+    publishedStats.read(s);
+    out.appendf("{\"mode\":\"%s\",\"timeSynced\":%s,\"days\":%" PRIu32 ",\"totalStarts\":%" PRIu32
+                ",\"totalRefusals\":%" PRIu32 ",\"today\":",
+                policy.isAdaptive() ? "adaptive" : "hysteresis", s.timeSynced ? "true" : "false", s.completedDays,
+                s.totalStarts, s.totalRefusals);
+    writeDayJson(out, s.today);
+    out.append(",\"lastDay\":");
+    writeDayJson(out, s.lastDay);
+    out.append(",\"policy\":");
+    policy.writeJson(s.model, out);
+    out.append("}");
+}
+
+// --- Zadanie sterujące ---
+
+void PumpController::controlTaskEntry(void* arg) {
+    static_cast<PumpController*>(arg)->controlTask();
+}
+
+void PumpController::controlTask() {
+    const TickType_t periodTicks = pdMS_TO_TICKS(controlPeriodMs);
+    const uint32_t periodUs = controlPeriodMs * 1000;
+    TickType_t lastWake = xTaskGetTickCount();
+
+    // Bazą jest pierwsze faktyczne wybudzenie (na granicy ticku), a nie chwila
+    // utworzenia zadania gdzieś w środku ticku
+    vTaskDelayUntil(&lastWake, periodTicks);
+    uint32_t expectedUs = micros() - periodUs;
+
+    for (;;) {
+        expectedUs += periodUs;
+        int32_t lateUs = (int32_t)(micros() - expectedUs);
+        // Po dłuższym zatrzymaniu (np. zapis do flash) zaczynamy liczyć od nowa
+        if (lateUs > (int32_t)periodUs) {
+            stats.deadlineMisses++;
+            expectedUs = micros();
+        }
+
+        uint32_t startCycles = ESP.getCycleCount();
+        controlCycle();
+        stats.cycleCpuCycles += ESP.getCycleCount() - startCycles;
+
+        // Opóźnienie: od planowanego początku okresu do zakończenia decyzji i zapisu przekaźnika
+        // (wybudzenie odrobinę przed planem przy dryfie micros() względem ticku liczy się jako 0)
+        int32_t latencyUs = (int32_t)(micros() - expectedUs);
+        if (latencyUs < 0) latencyUs = 0;
+        recordLatency(latencyUs);
+        if ((uint32_t)latencyUs > periodUs) stats.deadlineMisses++;
+        stats.cycles++;
+        vTaskDelayUntil(&lastWake, periodTicks);
+    }
+}
+
+void PumpController::controlCycle() {
+    PumpCommand cmd;
+    while (xQueueReceive(commandQueue, &cmd, 0) == pdTRUE) {
+        processCommand(cmd);
+    }
+
+    uint8_t inputs = sampleInputs();
+    readSensors(inputs);
+    // Model uczy się na pasmach po debouncingu we wszystkich trybach poza testowym
+    if (!state.testMode && millis() - lastSensorChangeTime > sensorDebounceTime) {
+        policy.observe(currentBand(), state.pumpOn, state.midSensorPresent, millis());
+    }
+    handleManualButton(inputs);
     handleAutoControl();
-    
+    updateDailyStats();
+
     // Sprawdzenie timeoutu dla trybu ręcznego
-    if (systemState.manualMode && !systemState.testMode && (millis() - systemState.manualModeStartTime > systemState.manualModeTimeout)) {
-        systemState.manualMode = false;
-        systemState.addEvent("Automatyczne wyłączenie trybu manualnego po 30 minutach");
+    if (state.manualMode && !state.testMode && (millis() - state.manualModeStartTime > systemState.manualModeTimeout)) {
+        state.manualMode = false;
+        stateDirty = true;
+        notify(NOTICE_MANUAL_TIMEOUT);
     }
+
+    if (stateDirty) {
+        systemState.control.publish(state);
+        stateDirty = false;
+    }
+    if (statsDirty || millis() - statsPublishTime >= statsPublishInterval) publishStats();
 }
 
-void PumpController::readSensors() {
-    bool currentLow = digitalRead(sensorLowPin) == LOW;
-    bool currentHigh = digitalRead(sensorHighPin) == LOW;
-    bool currentMid = (sensorMidPin != -1) ? (digitalRead(sensorMidPin) == LOW) : false;
+void PumpController::publishStats() {
+    stats.timeSynced = cachedMinuteOfDay >= 0;
+    stats.model = policy.learned();
+    publishedStats.publish(stats);
+    statsPublishTime = millis();
+    statsDirty = false;
+}
 
-    if (currentLow != systemState.sensorLowState || currentHigh != systemState.sensorHighState || currentMid != systemState.sensorMidState) {
-        lastSensorChangeTime = millis();
+void PumpController::recordLatency(uint32_t latencyUs) {
+    int bucket = 0;
+    while (bucket < LATENCY_BUCKETS - 1 && latencyUs >= LATENCY_BOUNDS_US[bucket]) bucket++;
+    stats.latencyHistogram[bucket]++;
+    if (latencyUs > stats.maxLatencyUs) stats.maxLatencyUs = latencyUs;
+}
+
+void PumpController::notify(PumpNotice notice) {
+    if (xQueueSend(noticeQueue, &notice, 0) != pdTRUE) stats.noticesDropped++;
+}
+
+void PumpController::setRelay(bool on) {
+    if (on && !state.pumpOn) {
+        stats.today.cycles++;
+        stats.totalStarts++;
+        statsDirty = true;
     }
-    
-    systemState.sensorLowState = currentLow;
-    systemState.sensorHighState = currentHigh;
-    systemState.sensorMidState = currentMid;
+    writeRelay(on);
+    state.pumpOn = on;
+    stateDirty = true;
+}
 
-    if (systemState.testMode) {
-        systemState.sensorLowState = true;
-        systemState.sensorHighState = true;
-        systemState.sensorMidState = (sensorMidPin != -1);
+void PumpController::processCommand(const PumpCommand& cmd) {
+    switch (cmd.type) {
+        case PUMP_CMD_TOGGLE:
+            if (canTogglePump(true)) {
+                state.manualMode = true;
+                state.manualModeStartTime = millis();
+                bool on = !state.pumpOn;
+                if (cmd.source == PUMP_SRC_BUTTON) switchPump(on, on ? NOTICE_BUTTON_ON : NOTICE_BUTTON_OFF);
+                else switchPump(on, on ? NOTICE_WEB_ON : NOTICE_WEB_OFF);
+            }
+            break;
+        case PUMP_CMD_SET:
+            setRelay(cmd.value);
+            break;
+        case PUMP_CMD_TEST:
+            state.testMode = !state.testMode;
+            state.manualMode = state.testMode;
+            if (state.testMode) state.manualModeStartTime = millis();
+            stateDirty = true;
+            notify(state.testMode ? NOTICE_TEST_ON : NOTICE_TEST_OFF);
+            break;
+        case PUMP_CMD_AUTO:
+            state.manualMode = false;
+            state.testMode = false; // Wyjście z trybu manualnego wyłącza też testowy
+            stateDirty = true;
+            notify(NOTICE_AUTO_RESTORED);
+            break;
     }
+}
 
-    if (systemState.sensorHighState) systemState.waterLevel = 100;
-    else if (systemState.sensorMidState) systemState.waterLevel = 65;
-    else if (systemState.sensorLowState) systemState.waterLevel = 30;
-    else systemState.waterLevel = 5;
+// Ogólna ścieżka przez warstwę Arduino - piny nieznane w czasie kompilacji
+uint8_t PumpController::sampleRuntimeInputs() {
+    uint8_t inputs = 0;
+    if (digitalRead(sensorLowPin) == LOW) inputs |= PUMP_IN_LOW;
+    if (digitalRead(sensorHighPin) == LOW) inputs |= PUMP_IN_HIGH;
+    if (sensorMidPin != -1 && digitalRead(sensorMidPin) == LOW) inputs |= PUMP_IN_MID;
+    if (manualButtonPin != -1 && digitalRead(manualButtonPin) == LOW) inputs |= PUMP_IN_BUTTON;
+    return inputs;
 }
 
-void PumpController::handleAutoControl() {
-    if (systemState.manualMode || systemState.testMode) return;
+WaterBand PumpController::currentBand() const {
+    if (state.sensorHighState) return BAND_HIGH;
+    if (state.sensorMidState) return BAND_MID;
+    if (state.sensorLowState) return BAND_LOW;
+    return BAND_EMPTY;
+}
 
-    if (millis() - lastSensorChangeTime > sensorDebounceTime) {
-        if (systemState.sensorHighState && systemState.pumpOn && canTogglePump()) {
-            digitalWrite(relayPin, LOW);
-            systemState.pumpOn = false;
-            lastPumpToggleTime = millis();
-            pumpToggleCount++;
-            systemState.addEvent("Automatyczne wyłączenie pompy (górny czujnik)");
-            notifier.sendPushover("Pompa została automatycznie wyłączona - zbiornik pełny");
-        } else if (!systemState.sensorLowState && !systemState.pumpOn && canTogglePump()) {
-            digitalWrite(relayPin, HIGH);
-            systemState.pumpOn = true;
-            lastPumpToggleTime = millis();
-            pumpToggleCount++;
-            systemState.addEvent("Automatyczne włączenie pompy (brak wody)");
-            notifier.sendPushover("Pompa została automatycznie włączona - niski poziom wody");
+// Minuta doby czasu lokalnego albo -1, dopóki NTP nie ustawi zegara
+int PumpController::minuteOfDay() {
+    if (millis() - minuteCheckTime >= 10000 || minuteCheckTime == 0) {
+        minuteCheckTime = millis();
+        time_t now = time(nullptr);
+        struct tm local;
+        if (now > 1600000000 && localtime_r(&now, &local)) {
+            cachedMinuteOfDay = local.tm_hour * 60 + local.tm_min;
+        } else {
+            cachedMinuteOfDay = -1;
         }
     }
+    return cachedMinuteOfDay;
 }
 
-void PumpController::handleManualButton() {
-    bool reading = digitalRead(manualButtonPin);
-    if (reading != lastButtonState) {
-        lastButtonDebounceTime = millis();
+void PumpController::updateDailyStats() {
+    if (state.pumpOn) {
+        stats.today.runMs += controlPeriodMs;
+        if (policy.isPeak(minuteOfDay())) stats.today.peakRunMs += controlPeriodMs;
+    }
+    if (millis() - dayStartTime >= 24UL * 3600 * 1000) {
+        dayStartTime += 24UL * 3600 * 1000;
+        stats.lastDay = stats.today;
+        stats.today = {};
+        stats.completedDays++;
+        statsDirty = true;
     }
+}
+
+void PumpController::readSensors(uint8_t inputs) {
+    bool currentLow = inputs & PUMP_IN_LOW;
+    bool currentHigh = inputs & PUMP_IN_HIGH;
+    bool currentMid = inputs & PUMP_IN_MID;
+
+    uint8_t raw = inputs & (PUMP_IN_LOW | PUMP_IN_MID | PUMP_IN_HIGH);
+    if (raw != state.rawInputs) {
+        state.rawInputs = raw;
+        stateDirty = true;
+    }
+
+    if (state.testMode) {
+        currentLow = true;
+        currentHigh = true;
+        currentMid = state.midSensorPresent;
+    }
+
+    if (currentLow != state.sensorLowState || currentHigh != state.sensorHighState || currentMid != state.sensorMidState) {
+        lastSensorChangeTime = millis();
+        stateDirty = true;
+    }
+
+    state.sensorLowState = currentLow;
+    state.sensorHighState = currentHigh;
+    state.sensorMidState = currentMid;
+
+    if (state.sensorHighState) state.waterLevel = 100;
+    else if (state.sensorMidState) state.waterLevel = 65;
+    else if (state.sensorLowState) state.waterLevel = 30;
+    else state.waterLevel = 5;
+}
+
+void PumpController::handleAutoControl() {
+    if (state.manualMode || state.testMode) return;
 
-    if ((millis() - lastButtonDebounceTime) > buttonDebounceDelay) {
-        if (reading != digitalRead(manualButtonPin)) { // Double check
-             lastButtonState = reading;
-             if (reading == LOW) { // Przycisk naciśnięty
-                 if (millis() - lastButtonPressTime > buttonPressDelay) {
-                    lastButtonPressTime = millis();
-                    togglePumpManual();
-                    systemState.addEvent(String("Przycisk BOOT POMPA – ") + (systemState.pumpOn ? "WŁĄCZONA" : "WYŁĄCZONA"));
-                    notifier.sendPushover(String("Przycisk BOOT POMPA: ") + (systemState.pumpOn ? "włączono" : "wyłączono"));
-                 }
-             }
+    if (millis() - lastSensorChangeTime > sensorDebounceTime) {
+        if (state.sensorHighState && state.pumpOn && canTogglePump()) {
+            switchPump(false, NOTICE_AUTO_OFF);
+        } else if (!state.sensorLowState && !state.pumpOn && canTogglePump()) {
+            switchPump(true, NOTICE_AUTO_ON);
+        } else if (policy.isAdaptive()) {
+            applyAdvice();
         }
     }
-    lastButtonState = reading;
 }
 
+// Porady są opcjonalne: wykonywane tylko wtedy, gdy zabezpieczenia pozwalają
+// bez blokady i w limicie na minutę zostaje miejsce na obowiązkowe przełączenie
+void PumpController::applyAdvice() {
+    PumpAdvice advice = policy.advise(currentBand(), state.pumpOn, minuteOfDay());
+    if (advice == ADVICE_KEEP || toggleRefusal() >= 0 || pumpToggleCount + 1 >= maxPumpTogglesPerMinute) return;
 
-void PumpController::togglePumpManual() {
-    if (canTogglePump(true)) {
-        systemState.manualMode = true;
-        systemState.manualModeStartTime = millis();
-        systemState.pumpOn = !systemState.pumpOn;
-        digitalWrite(relayPin, systemState.pumpOn ? HIGH : LOW);
-        lastPumpToggleTime = millis();
-        pumpToggleCount++;
+    if (advice == ADVICE_PREFILL) {
+        switchPump(true, NOTICE_PREFILL_ON);
+        policy.notePrefill();
+    } else {
+        switchPump(false, NOTICE_PEAK_OFF);
+    }
+}
+
+void PumpController::switchPump(bool on, PumpNotice notice) {
+    setRelay(on);
+    lastPumpToggleTime = millis();
+    pumpToggleCount++;
+    notify(notice);
+}
+
+// Naciśnięcie liczy się, gdy odczyt był stabilny przez buttonDebounceDelay
+void PumpController::handleManualButton(uint8_t inputs) {
+    bool reading = inputs & PUMP_IN_BUTTON;
+    if (reading != lastButtonReading) {
+        lastButtonDebounceTime = millis();
+        lastButtonReading = reading;
+    }
+
+    if ((millis() - lastButtonDebounceTime) > buttonDebounceDelay && reading != buttonPressed) {
+        buttonPressed = reading;
+        if (buttonPressed && millis() - lastButtonPressTime > buttonPressDelay) {
+            lastButtonPressTime = millis();
+            processCommand({ PUMP_CMD_TOGGLE, PUMP_SRC_BUTTON, false });
+        }
     }
 }
 
@@ -121,22 +388,30 @@ void PumpController::togglePumpManual() {
 bool PumpController::canTogglePump(bool manualOverride) {
     if (manualOverride) return true;
 
+    int refusal = toggleRefusal();
+    if (refusal >= 0) {
+        if (lastRefusal != refusal) {
+            notify((PumpNotice)refusal);
+            stats.today.refusals++;
+            stats.totalRefusals++;
+            statsDirty = true;
+        }
+        lastRefusal = refusal;
+        return false;
+    }
+    lastRefusal = -1;
+    return true;
+}
+
+// Powód blokady przełączenia (NOTICE_TOGGLE_*) albo -1
+int PumpController::toggleRefusal() {
     unsigned long now = millis();
     if (now - lastMinuteCheck > 60000) {
         pumpToggleCount = 0;
         lastMinuteCheck = now;
     }
 
-    if (pumpToggleCount >= maxPumpTogglesPerMinute) {
-        systemState.addEvent("Osiągnięto limit przełączeń pompy (4/min)");
-        notifier.sendPushover("Osiągnięto limit przełączeń pompy (4/min) - bezpiecznik");
-        return false;
-    }
-
-    if (now - lastPumpToggleTime < minPumpToggleInterval) {
-        systemState.addEvent("Zbyt częste przełączanie pompy - bezpiecznik");
-        notifier.sendPushover("Zbyt częste przełączanie pompy - bezpiecznik");
-        return false;
-    }
-    return true;
+    if (pumpToggleCount >= maxPumpTogglesPerMinute) return NOTICE_TOGGLE_LIMIT;
+    if (now - lastPumpToggleTime < minPumpToggleInterval) return NOTICE_TOGGLE_TOO_FAST;
+    return -1;
 }
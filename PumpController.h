@@ -2,21 +2,142 @@
 #define PUMP_CONTROLLER_H
 
 #include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
 #include "SystemState.h"
 #include "Notifier.h"
+#include "TextBuffer.h"
+#include "PumpPolicy.h"
 
+// Polecenia dla zadania sterującego (WWW, MQTT, przycisk)
+enum PumpCommandType : uint8_t {
+    PUMP_CMD_TOGGLE,   // przełącz pompę i wejdź w tryb ręczny
+    PUMP_CMD_SET,      // ustaw stan pompy (MQTT pump/set)
+    PUMP_CMD_TEST,     // przełącz tryb testowy
+    PUMP_CMD_AUTO      // przywróć sterowanie automatyczne
+};
+
+enum PumpCommandSource : uint8_t {
+    PUMP_SRC_WEB,
+    PUMP_SRC_BUTTON,
+    PUMP_SRC_MQTT
+};
+
+struct PumpCommand {
+    PumpCommandType type;
+    PumpCommandSource source;
+    bool value;
+};
+
+// Komunikaty zadania sterującego - zamieniane na zdarzenia i Pushover w loop()
+enum PumpNotice : uint8_t {
+    NOTICE_AUTO_OFF,
+    NOTICE_AUTO_ON,
+    NOTICE_MANUAL_TIMEOUT,
+    NOTICE_TOGGLE_LIMIT,
+    NOTICE_TOGGLE_TOO_FAST,
+    NOTICE_WEB_ON,
+    NOTICE_WEB_OFF,
+    NOTICE_BUTTON_ON,
+    NOTICE_BUTTON_OFF,
+    NOTICE_TEST_ON,
+    NOTICE_TEST_OFF,
+    NOTICE_AUTO_RESTORED,
+    NOTICE_PREFILL_ON,
+    NOTICE_PEAK_OFF,
+    NOTICE_COUNT
+};
+
+// Bity jednego odczytu wejść; ustawiony bit = zwarty do masy (aktywny stanem niskim)
+enum PumpInput : uint8_t {
+    PUMP_IN_LOW = 0x01,
+    PUMP_IN_MID = 0x02,
+    PUMP_IN_HIGH = 0x04,
+    PUMP_IN_BUTTON = 0x08
+};
+
+#define LATENCY_BUCKETS 8
+
+// Liczniki pracy pompy w jednej dobie (okna 24 h czasu pracy urządzenia)
+struct PumpDayStats {
+    uint32_t cycles;   // włączenia przekaźnika
+    uint32_t runMs;
+    uint32_t peakRunMs; // praca w godzinach szczytu taryfy
+    uint32_t refusals; // blokady przez zabezpieczenia ("bezpiecznik")
+};
+
+// Liczniki zadania sterującego dla innych wątków. Publikowane jako migawka
+// (SeqLatch, jak ControlState): wiele pól i liczniki 64-bitowe czytane wprost
+// z wątku loop() mogłyby trafić w połowę aktualizacji.
+struct PumpTaskStats {
+    uint32_t cycles = 0;
+    uint64_t cycleCpuCycles = 0; // łączny czas pracy cykli sterowania [cykle CPU]
+    uint32_t deadlineMisses = 0;
+    uint32_t maxLatencyUs = 0;
+    uint32_t latencyHistogram[LATENCY_BUCKETS] = {};
+    uint32_t noticesDropped = 0;
+
+    // Cykle pompy na dobę - w obu trybach, do porównania trybów na tej samej instalacji
+    PumpDayStats today = {};
+    PumpDayStats lastDay = {};
+    uint32_t completedDays = 0;
+    uint32_t totalStarts = 0;
+    uint32_t totalRefusals = 0;
+    bool timeSynced = false;
+    PumpModel model;
+};
+
+// Odczyt czujników, zabezpieczenia i przekaźnik działają w osobnym zadaniu
+// FreeRTOS o wysokim priorytecie i stałym okresie, niezależnie od WWW, MQTT
+// i blokującego HTTPS. Reszta systemu komunikuje się z nim wyłącznie przez
+// kolejkę poleceń (wejście), kolejkę komunikatów i migawkę SystemState::control (wyjście).
+// Wersja ogólna używa pinów z NVS; profile płytek z pinami znanymi w czasie
+// kompilacji - patrz BoardPumpController.h.
 class PumpController {
 public:
     PumpController(SystemState& state, Notifier& notifier);
+    virtual ~PumpController() = default;
     void begin(int lowPin, int highPin, int midPin, int relayPin, int buttonPin);
+    void configurePolicy(bool adaptive, uint32_t peakHours) { policy.configure(adaptive, peakHours); } // przed begin()
     void loop();
-    void togglePumpManual();
+    bool sendCommand(PumpCommandType type, PumpCommandSource source, bool value = false);
+    void writeJson(TextBuffer& out) const;
+    void writeCyclesJson(TextBuffer& out) const;
+    // Ostatnia migawka liczników (odświeżana co sekundę i po starcie lub blokadzie)
+    uint32_t readStats(PumpTaskStats& out) const { return publishedStats.read(out); }
+
+protected:
+    // Jeden odczyt wszystkich wejść na cykl (bity PUMP_IN_*) i zapis przekaźnika
+    virtual uint8_t sampleInputs() { return sampleRuntimeInputs(); }
+    virtual void writeRelay(bool on) { digitalWrite(relayPin, on ? HIGH : LOW); }
+    virtual const char* profileName() const { return "runtime"; }
+    uint8_t sampleRuntimeInputs();
+    // Jeden okres sterowania; na urządzeniu woła go zadanie, symulacja hosta - sama
+    void controlCycle();
+
+    // Koszt jednego odczytu wejść [cykle CPU] - wypełniane przez profile płytek
+    uint32_t benchRuntimeCycles = 0;
+    uint32_t benchStaticCycles = 0;
 
 private:
-    void readSensors();
+    static void controlTaskEntry(void* arg);
+    void controlTask();
+    void processCommand(const PumpCommand& cmd);
+    void readSensors(uint8_t inputs);
     void handleAutoControl();
-    void handleManualButton();
+    void applyAdvice();
+    void handleManualButton(uint8_t inputs);
     bool canTogglePump(bool manualOverride = false);
+    int toggleRefusal();
+    void switchPump(bool on, PumpNotice notice);
+    void setRelay(bool on);
+    void updateDailyStats();
+    WaterBand currentBand() const;
+    int minuteOfDay();
+    void notify(PumpNotice notice);
+    void recordLatency(uint32_t latencyUs);
+    void publishStats();
 
     SystemState& systemState;
     Notifier& notifier;
@@ -24,23 +145,52 @@ private:
     // Piny
     int sensorLowPin, sensorHighPin, sensorMidPin, relayPin, manualButtonPin;
 
+    // Zadanie sterujące i kolejki
+    static const uint32_t controlPeriodMs = 10;
+    static const UBaseType_t controlTaskPriority = 20; // powyżej lwIP (18), poniżej sterownika WiFi (23)
+    TaskHandle_t controlTaskHandle = nullptr;
+    QueueHandle_t commandQueue = nullptr;
+    QueueHandle_t noticeQueue = nullptr;
+
+    // Stan należący do zadania sterującego (publikowany jako migawka)
+    ControlState state;
+    bool stateDirty = true;
+
     // Zabezpieczenia
     unsigned long lastPumpToggleTime = 0;
     const unsigned long minPumpToggleInterval = 30000;
     int pumpToggleCount = 0;
     const int maxPumpTogglesPerMinute = 4;
     unsigned long lastMinuteCheck = 0;
+    int lastRefusal = -1; // ostatni zgłoszony powód blokady, by nie zalewać komunikatami
 
     // Debouncing czujników
     unsigned long lastSensorChangeTime = 0;
     const unsigned long sensorDebounceTime = 5000;
 
-    // Debouncing przycisku
-    bool lastButtonState = HIGH;
+    // Debouncing przycisku (stan "wciśnięty")
+    bool lastButtonReading = false;
+    bool buttonPressed = false;
     unsigned long lastButtonDebounceTime = 0;
     const unsigned long buttonDebounceDelay = 50;
     unsigned long lastButtonPressTime = 0;
     const unsigned long buttonPressDelay = 1000;
+
+    // Sterowanie adaptacyjne i taryfa (czas lokalny z NTP, odświeżany co 10 s)
+    PumpPolicy policy;
+    int cachedMinuteOfDay = -1;
+    unsigned long minuteCheckTime = 0;
+
+    unsigned long dayStartTime = 0;
+
+    // Liczniki należące do zadania sterującego i ich migawka dla reszty systemu
+    PumpTaskStats stats;
+    SeqLatch<PumpTaskStats> publishedStats;
+    bool statsDirty = false;
+    unsigned long statsPublishTime = 0;
+    const unsigned long statsPublishInterval = 1000;
+
+    uint32_t commandsDropped = 0; // zapisywane przez nadawców poleceń, nie przez zadanie
 };
 
 #endif
@@ -0,0 +1,265 @@
+#include "PumpPolicy.h"
+#include <inttypes.h>
+
+#define ALL_HOURS 0xFFFFFFu
+
+// Przełączenie pompy do tylu ms po wejściu w pasmo (debouncing czujników)
+// nie psuje pomiaru - odcinek liczony jest wtedy od przełączenia
+static const uint32_t SWITCH_GRACE_MS = 15000;
+// Zapas przy zatrzymaniu w szczycie: zbiornik ma wytrzymać tyle ponad koniec szczytu
+static const int PEAK_STOP_MARGIN_MIN = 15;
+// Dopełnianie zaczyna się, gdy do szczytu zostało tyle co czas napełniania + zapas
+static const int PREFILL_LEAD_MIN = 10;
+// Porada nie może zbliżyć kolejnego obowiązkowego przełączenia bardziej niż na
+// tyle - zostaje czas na odstęp wymagany przez zabezpieczenia przekaźnika
+static const uint32_t MIN_OPTIONAL_RUN_S = 120;
+// Cena dodatkowego cyklu przekaźnika w sekundach pracy w szczycie
+static const uint32_t START_COST_S = 4 * 3600;
+// Największa strata jednej porady w promilach cyklu
+static const uint32_t MAX_LOSS_PERMILLE = 100;
+// Mniejsza oszczędność w szczycie nie jest warta ryzyka złej prognozy
+static const uint32_t MIN_SAVED_S = 15 * 60;
+static const uint16_t MIN_SAMPLES = 2;
+
+void PumpPolicy::configure(bool adaptive, uint32_t peakHours) {
+    this->adaptive = adaptive;
+    this->peakHours = peakHours & ALL_HOURS;
+}
+
+WaterBand PumpPolicy::nextUp(WaterBand from) const {
+    if (from == BAND_EMPTY) return BAND_LOW;
+    if (from == BAND_LOW) return midPresent ? BAND_MID : BAND_HIGH;
+    return BAND_HIGH;
+}
+
+WaterBand PumpPolicy::nextDown(WaterBand from) const {
+    if (from == BAND_HIGH) return midPresent ? BAND_MID : BAND_LOW;
+    if (from == BAND_MID) return BAND_LOW;
+    return BAND_EMPTY;
+}
+
+void PumpPolicy::learn(uint32_t* seconds, uint16_t* samples, WaterBand at, uint32_t elapsedMs) {
+    int32_t sample = elapsedMs / 1000;
+    if (sample < 1) sample = 1;
+    // Średnia wykładnicza (waga 1/4) - nadąża za zmianą zużycia w ciągu kilku cykli
+    if (samples[at] == 0) seconds[at] = sample;
+    else seconds[at] += (sample - (int32_t)seconds[at]) / 4;
+    if (samples[at] < UINT16_MAX) samples[at]++;
+}
+
+// Wywoływane co cykl z pasmem po debouncingu
+void PumpPolicy::observe(WaterBand newBand, bool newPumpOn, bool hasMid, uint32_t nowMs) {
+    midPresent = hasMid;
+    lastMs = nowMs;
+    if (!started) {
+        // Moment wejścia w pierwsze pasmo po starcie nie jest znany
+        started = true;
+        band = newBand;
+        pumpOn = newPumpOn;
+        bandEnteredMs = segmentStartMs = nowMs;
+        return;
+    }
+
+    if (newBand != band) {
+        uint32_t elapsed = nowMs - segmentStartMs;
+        if (segmentValid && pumpOn && newBand == nextUp(band)) {
+            learn(model.fillSeconds, model.fillSamples, band, elapsed);
+        } else if (segmentValid && !pumpOn && newBand == nextDown(band)) {
+            learn(model.drainSeconds, model.drainSamples, band, elapsed);
+        }
+        band = newBand;
+        bandEnteredMs = segmentStartMs = nowMs;
+        segmentValid = true;
+    }
+
+    if (newPumpOn != pumpOn) {
+        segmentValid = segmentValid && nowMs - bandEnteredMs <= SWITCH_GRACE_MS;
+        segmentStartMs = nowMs;
+        pumpOn = newPumpOn;
+    }
+}
+
+// Przewidywany czas do górnego czujnika przy włączonej pompie
+bool PumpPolicy::fillToHigh(WaterBand from, uint32_t& seconds) const {
+    seconds = 0;
+    for (WaterBand b = from; b != BAND_HIGH; b = nextUp(b)) {
+        if (model.fillSamples[b] < MIN_SAMPLES) return false;
+        uint32_t remaining = model.fillSeconds[b];
+        if (b == band && pumpOn && segmentValid) {
+            // Pasmo trwa dłużej niż zwykle - model nie opisuje bieżących warunków
+            uint32_t elapsed = (lastMs - segmentStartMs) / 1000;
+            if (elapsed >= remaining) return false;
+            remaining -= elapsed;
+        }
+        seconds += remaining;
+    }
+    return true;
+}
+
+// Przewidywany czas do osuszenia dolnego czujnika przy wyłączonej pompie
+bool PumpPolicy::drainToEmpty(WaterBand from, uint32_t& seconds) const {
+    seconds = 0;
+    for (WaterBand b = from; b != BAND_EMPTY; b = nextDown(b)) {
+        if (model.drainSamples[b] < MIN_SAMPLES) return false;
+        uint32_t remaining = model.drainSeconds[b];
+        if (b == band && !pumpOn && segmentValid) {
+            uint32_t elapsed = (lastMs - segmentStartMs) / 1000;
+            if (elapsed >= remaining) return false;
+            remaining -= elapsed;
+        }
+        seconds += remaining;
+    }
+    return true;
+}
+
+bool PumpPolicy::isPeak(int minuteOfDay) const {
+    return minuteOfDay >= 0 && (peakHours & (1u << (minuteOfDay / 60)));
+}
+
+int PumpPolicy::minutesToPeak(int minuteOfDay) const {
+    if (isPeak(minuteOfDay)) return 0;
+    int hour = minuteOfDay / 60;
+    for (int i = 1; i <= 24; i++) {
+        if (peakHours & (1u << ((hour + i) % 24))) return i * 60 - minuteOfDay % 60;
+    }
+    return -1;
+}
+
+int PumpPolicy::minutesToOffPeak(int minuteOfDay) const {
+    if (!isPeak(minuteOfDay)) return 0;
+    int hour = minuteOfDay / 60;
+    for (int i = 1; i <= 24; i++) {
+        if (!(peakHours & (1u << ((hour + i) % 24)))) return i * 60 - minuteOfDay % 60;
+    }
+    return 24 * 60;
+}
+
+// Pełny cykl z nauczonego modelu: napełnianie pusty-górny i opróżnianie górny-pusty
+bool PumpPolicy::fullCycle(uint32_t& fill, uint32_t& drain) const {
+    fill = drain = 0;
+    for (WaterBand b = BAND_EMPTY; b != BAND_HIGH; b = nextUp(b)) {
+        if (model.fillSamples[b] < MIN_SAMPLES) return false;
+        fill += model.fillSeconds[b];
+    }
+    for (WaterBand b = BAND_HIGH; b != BAND_EMPTY; b = nextDown(b)) {
+        if (model.drainSamples[b] < MIN_SAMPLES) return false;
+        drain += model.drainSeconds[b];
+    }
+    return fill > 0 && drain > 0;
+}
+
+// Część sekund [from, from+length) przypadająca na szczyt; momenty w sekundach od
+// początku doby, okno może przejść przez północ
+uint32_t PumpPolicy::peakSeconds(uint32_t from, uint32_t length) const {
+    uint32_t total = 0;
+    while (length > 0) {
+        uint32_t second = from % 86400;
+        uint32_t toHour = 3600 - second % 3600;
+        uint32_t chunk = length < toHour ? length : toHour;
+        if (peakHours & (1u << (second / 3600))) total += chunk;
+        from += chunk;
+        length -= chunk;
+    }
+    return total;
+}
+
+// Pełne pasmo dolny-górny daje najmniej cykli przekaźnika, a każda porada skraca
+// bieg albo postój, więc kosztuje ułamek cyklu: dopełnienie traci zapas, który
+// jeszcze był w zbiorniku, zatrzymanie na środkowym - niedolaną wodę. Porada
+// przechodzi tylko wtedy, gdy ten ułamek jest mały (MAX_LOSS_PERMILLE), a
+// zaoszczędzona praca w szczycie pokrywa go po cenie START_COST_S za cały cykl.
+// Kolejne obowiązkowe przełączenie musi wypaść co najmniej MIN_OPTIONAL_RUN_S
+// później, więc porada nie prowadzi do blokady. Bez nauczonego modelu zawsze
+// ADVICE_KEEP.
+PumpAdvice PumpPolicy::advise(WaterBand current, bool on, int minuteOfDay) {
+    if (!adaptive || minuteOfDay < 0 || peakHours == 0) return ADVICE_KEEP;
+
+    uint32_t cycleFill, cycleDrain;
+    if (!fullCycle(cycleFill, cycleDrain)) return ADVICE_KEEP;
+    uint32_t now = (uint32_t)minuteOfDay * 60;
+    uint32_t lasts, fill;
+
+    if (isPeak(minuteOfDay)) {
+        prefillArmed = true; // kolejne podejście do szczytu
+        if (!on || current != BAND_MID || !fillToHigh(BAND_MID, fill) || !drainToEmpty(BAND_MID, lasts)) {
+            return ADVICE_KEEP;
+        }
+        // Zapas ma wystarczyć do końca szczytu z marginesem; start po nim
+        // wypada poza szczytem, więc oszczędzona jest cała reszta biegu w szczycie
+        uint32_t toOffPeak = (uint32_t)minutesToOffPeak(minuteOfDay) * 60;
+        if (lasts < toOffPeak + PEAK_STOP_MARGIN_MIN * 60) return ADVICE_KEEP;
+        uint32_t saved = peakSeconds(now, fill);
+        uint32_t loss = fill * 1000 / cycleFill;
+        return worthIt(saved, loss) ? ADVICE_PEAK_STOP : ADVICE_KEEP;
+    }
+
+    if (on || !prefillArmed || current == BAND_EMPTY || current == BAND_HIGH) return ADVICE_KEEP;
+    int toPeak = minutesToPeak(minuteOfDay);
+    if (toPeak < 0) return ADVICE_KEEP;
+    if (!fillToHigh(current, fill) || !drainToEmpty(current, lasts)) return ADVICE_KEEP;
+    if (fill < MIN_OPTIONAL_RUN_S || cycleDrain < MIN_OPTIONAL_RUN_S) return ADVICE_KEEP;
+    // Najpóźniej, jak się da: im później dopełnienie, tym mniej zapasu traci
+    if ((uint32_t)toPeak * 60 > fill + PREFILL_LEAD_MIN * 60) return ADVICE_KEEP;
+
+    // Bez porady: start przy pustym za `lasts` i pełny bieg; z poradą: bieg teraz
+    uint32_t keep = peakSeconds(now + lasts, cycleFill);
+    uint32_t advised = peakSeconds(now, fill);
+    uint32_t saved = keep > advised ? keep - advised : 0;
+    uint32_t loss = lasts * 1000 / cycleDrain;
+    return worthIt(saved, loss) ? ADVICE_PREFILL : ADVICE_KEEP;
+}
+
+// Zysk w szczycie [s] wobec straty w promilach cyklu
+bool PumpPolicy::worthIt(uint32_t saved, uint32_t lossPermille) const {
+    if (saved < MIN_SAVED_S || lossPermille > MAX_LOSS_PERMILLE) return false;
+    return (uint64_t)saved * 1000 >= (uint64_t)lossPermille * START_COST_S;
+}
+
+void PumpPolicy::writeJson(const PumpModel& snapshot, TextBuffer& out) const {
+    out.appendf("{\"adaptive\":%s,\"peakHours\":\"", adaptive ? "true" : "false");
+    formatHours(peakHours, out);
+    out.append("\",\"fillS\":[");
+    for (int b = 0; b < BAND_COUNT; b++) out.appendf("%s%" PRIu32, b ? "," : "", snapshot.fillSamples[b] ? snapshot.fillSeconds[b] : 0);
+    out.append("],\"drainS\":[");
+    for (int b = 0; b < BAND_COUNT; b++) out.appendf("%s%" PRIu32, b ? "," : "", snapshot.drainSamples[b] ? snapshot.drainSeconds[b] : 0);
+    out.append("],\"samples\":[");
+    for (int b = 0; b < BAND_COUNT; b++) out.appendf("%s%u", b ? "," : "", (unsigned)(snapshot.fillSamples[b] + snapshot.drainSamples[b]));
+    out.append("]}");
+}
+
+// "6-13,15-22" = godziny 6..12 i 15..21; "22-6" przechodzi przez północ
+uint32_t PumpPolicy::parseHours(const char* text) {
+    uint32_t mask = 0;
+    while (*text) {
+        if (!isdigit((unsigned char)*text)) { text++; continue; }
+        char* end;
+        int from = strtol(text, &end, 10);
+        int to = from + 1;
+        if (*end == '-') to = strtol(end + 1, &end, 10);
+        text = end;
+        if (from > 23 || to > 24 || to == from) continue;
+        int length = (to - from + 24) % 24;
+        if (length == 0) length = 24;
+        for (int i = 0; i < length; i++) mask |= 1u << ((from + i) % 24);
+    }
+    return mask;
+}
+
+void PumpPolicy::formatHours(uint32_t mask, TextBuffer& out) {
+    mask &= ALL_HOURS;
+    if (mask == ALL_HOURS) { out.append("0-24"); return; }
+    // Start od godziny poza szczytem, by zakres przez północ był jednym odcinkiem
+    int base = 0;
+    while (mask & (1u << base)) base++;
+    bool first = true;
+    for (int i = 1; i <= 24; i++) {
+        int h = (base + i) % 24;
+        if (!(mask & (1u << h))) continue;
+        int length = 0;
+        while (mask & (1u << ((h + length) % 24))) length++;
+        int end = h + length > 24 ? h + length - 24 : h + length;
+        out.appendf("%s%d-%d", first ? "" : ",", h, end);
+        first = false;
+        i += length - 1;
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef PUMP_POLICY_H
+#define PUMP_POLICY_H
+
+#include <Arduino.h>
+#include "TextBuffer.h"
+
+// Pasmo poziomu wody wyznaczone z czujników
+enum WaterBand : uint8_t {
+    BAND_EMPTY, // dolny czujnik suchy - pompa musi ruszyć
+    BAND_LOW,   // dolny mokry, środkowy suchy (lub brak środkowego)
+    BAND_MID,   // środkowy mokry, górny suchy
+    BAND_HIGH,  // górny mokry - pompa musi stanąć
+    BAND_COUNT
+};
+
+// Decyzje opcjonalne; progi dolny/górny obsługuje zawsze PumpController
+enum PumpAdvice : uint8_t {
+    ADVICE_KEEP,
+    ADVICE_PREFILL,  // dopełnij zbiornik przed szczytem taryfy
+    ADVICE_PEAK_STOP // zatrzymaj na środkowym - zapas wystarczy do końca szczytu
+};
+
+// Nauczony model: średni czas przejścia przez pasmo [s] w górę i w dół
+struct PumpModel {
+    uint32_t fillSeconds[BAND_COUNT] = {};
+    uint32_t drainSeconds[BAND_COUNT] = {};
+    uint16_t fillSamples[BAND_COUNT] = {};
+    uint16_t drainSamples[BAND_COUNT] = {};
+};
+
+// Adaptacyjne sterowanie pompą. Uczy się czasu przejścia przez każde pasmo
+// przy napełnianiu (pompa włączona) i opróżnianiu (pompa wyłączona) na
+// podstawie przełączeń czujników, a następnie doradza dodatkowe włączenie
+// lub wyłączenie, gdy przesuwa to pracę pompy poza godziny szczytu. Porada
+// skraca bieg albo postój, więc kosztuje ułamek cyklu przekaźnika - przechodzi
+// tylko, gdy ten ułamek jest mały, a oszczędność w szczycie go pokrywa (advise()).
+// Bez nauczonego modelu lub bez czasu z NTP doradza zawsze ADVICE_KEEP, czyli
+// zachowanie klasycznej histerezy.
+// Używana wyłącznie z zadania sterującego; model dla innych wątków
+// publikuje PumpController razem z licznikami (PumpTaskStats).
+class PumpPolicy {
+public:
+    void configure(bool adaptive, uint32_t peakHours);
+    bool isAdaptive() const { return adaptive; }
+
+    void observe(WaterBand band, bool pumpOn, bool midPresent, uint32_t nowMs);
+    PumpAdvice advise(WaterBand band, bool pumpOn, int minuteOfDay);
+    void notePrefill() { prefillArmed = false; }
+    bool isPeak(int minuteOfDay) const;
+
+    const PumpModel& learned() const { return model; }
+    // Konfiguracja (stała po starcie) i podany model - np. z migawki
+    void writeJson(const PumpModel& snapshot, TextBuffer& out) const;
+
+    // Godziny szczytu jako maska (bit h = godzina h), tekstowo np. "6-13,15-22"
+    static uint32_t parseHours(const char* text);
+    static void formatHours(uint32_t mask, TextBuffer& out);
+
+private:
+    WaterBand nextUp(WaterBand from) const;
+    WaterBand nextDown(WaterBand from) const;
+    bool fillToHigh(WaterBand from, uint32_t& seconds) const;
+    bool drainToEmpty(WaterBand from, uint32_t& seconds) const;
+    int minutesToPeak(int minuteOfDay) const;
+    int minutesToOffPeak(int minuteOfDay) const;
+    bool fullCycle(uint32_t& fill, uint32_t& drain) const;
+    uint32_t peakSeconds(uint32_t from, uint32_t length) const;
+    bool worthIt(uint32_t saved, uint32_t lossPermille) const;
+    void learn(uint32_t* seconds, uint16_t* samples, WaterBand band, uint32_t elapsedMs);
+
+    bool adaptive = false;
+    uint32_t peakHours = 0;
+    bool prefillArmed = true;
+
+    PumpModel model;
+
+    // Bieżący odcinek: pasmo i stan pompy od chwili segmentStartMs
+    WaterBand band = BAND_EMPTY;
+    bool pumpOn = false;
+    bool midPresent = false;
+    bool started = false;
+    bool segmentValid = false; // false, gdy początek odcinka nie jest znany
+    uint32_t bandEnteredMs = 0;
+    uint32_t segmentStartMs = 0;
+    uint32_t lastMs = 0;
+};
+
+#endif
@@ -0,0 +1,203 @@
+#include "Scheduler.h"
+#include "Logger.h"
+#include <inttypes.h>
+#include <esp_idf_version.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#if CONFIG_PM_ENABLE
+#include <esp_pm.h>
+#endif
+
+// Różnica ze znakiem - poprawna także po przepełnieniu millis() (co ~49 dni)
+static inline long timeUntil(unsigned long deadline, unsigned long now) {
+    return (long)(deadline - now);
+}
+
+Scheduler::Scheduler() {
+    for (int i = 0; i < MAX_TASKS; i++) heapPos[i] = -1;
+}
+
+void Scheduler::begin(bool lightSleep) {
+    if (lightSleep) {
+        lightSleepEnabled = enableLightSleep();
+        logger.info(LOG_SYS, "%s", lightSleepEnabled ? "Automatyczny light-sleep włączony"
+                                                     : "Light-sleep niedostępny w tej konfiguracji");
+    }
+}
+
+// Automatyczny light-sleep wymaga CONFIG_PM_ENABLE i tickless idle w sdkconfig;
+// bez nich planista i tak oddaje CPU do zadania idle zamiast kręcić pętlą.
+bool Scheduler::enableLightSleep() {
+#if CONFIG_PM_ENABLE && CONFIG_FREERTOS_USE_TICKLESS_IDLE && ESP_IDF_VERSION_MAJOR >= 5
+    esp_pm_config_t pmConfig = {};
+    pmConfig.max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+    pmConfig.min_freq_mhz = 40;
+    pmConfig.light_sleep_enable = true;
+    return esp_pm_configure(&pmConfig) == ESP_OK;
+#else
+    return false;
+#endif
+}
+
+int Scheduler::every(unsigned long periodMs, TaskCallback callback, void* arg) {
+    return add(periodMs, periodMs, callback, arg);
+}
+
+int Scheduler::after(unsigned long delayMs, TaskCallback callback, void* arg) {
+    return add(delayMs, 0, callback, arg);
+}
+
+int Scheduler::add(unsigned long delayMs, unsigned long periodMs, TaskCallback callback, void* arg) {
+    for (int id = 0; id < MAX_TASKS; id++) {
+        if (heapPos[id] != -1) continue;
+        tasks[id].callback = callback;
+        tasks[id].arg = arg;
+        tasks[id].period = periodMs;
+        tasks[id].deadline = millis() + delayMs;
+        heap[heapSize] = id;
+        heapPos[id] = heapSize;
+        siftUp(heapSize++);
+        return id;
+    }
+    logger.error(LOG_SYS, "Scheduler: brak wolnych slotów zadań");
+    return -1;
+}
+
+void Scheduler::cancel(int id) {
+    if (id < 0 || id >= MAX_TASKS || heapPos[id] == -1) return;
+    removeAt(heapPos[id]);
+}
+
+bool Scheduler::before(int a, int b) const {
+    return (long)(tasks[heap[a]].deadline - tasks[heap[b]].deadline) < 0;
+}
+
+void Scheduler::swapNodes(int i, int j) {
+    int t = heap[i];
+    heap[i] = heap[j];
+    heap[j] = t;
+    heapPos[heap[i]] = i;
+    heapPos[heap[j]] = j;
+}
+
+void Scheduler::siftUp(int i) {
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!before(i, parent)) break;
+        swapNodes(i, parent);
+        i = parent;
+    }
+}
+
+void Scheduler::siftDown(int i) {
+    for (;;) {
+        int smallest = i;
+        int l = 2 * i + 1, r = l + 1;
+        if (l < heapSize && before(l, smallest)) smallest = l;
+        if (r < heapSize && before(r, smallest)) smallest = r;
+        if (smallest == i) break;
+        swapNodes(i, smallest);
+        i = smallest;
+    }
+}
+
+void Scheduler::removeAt(int i) {
+    int id = heap[i];
+    heapSize--;
+    if (i != heapSize) {
+        swapNodes(i, heapSize);
+        siftDown(i);
+        siftUp(i);
+    }
+    heapPos[id] = -1;
+}
+
+void Scheduler::run() {
+    unsigned long startUs = micros();
+
+    // Wykonaj wszystkie zadania z minionym terminem
+    while (heapSize > 0) {
+        int id = heap[0];
+        Task& task = tasks[id];
+        unsigned long now = millis();
+        if (timeUntil(task.deadline, now) > 0) break;
+
+        TaskCallback callback = task.callback;
+        void* arg = task.arg;
+        if (task.period > 0) {
+            // Kolejny termin liczony od poprzedniego - bez dryfu; po dłuższym
+            // zatorze nie nadrabiamy zaległych wywołań seriami
+            task.deadline += task.period;
+            if (timeUntil(task.deadline, now) <= 0) task.deadline = now + task.period;
+            siftDown(0);
+        } else {
+            removeAt(0);
+        }
+        callback(arg);
+        tasksRun++;
+    }
+
+    unsigned long idleStartUs = micros();
+    loopBusyMicros += idleStartUs - startUs;
+    windowLoopBusyMicros += idleStartUs - startUs;
+
+    // Blokuj do najbliższego terminu
+    TickType_t waitTicks = portMAX_DELAY;
+    if (heapSize > 0) {
+        long waitMs = timeUntil(tasks[heap[0]].deadline, millis());
+        if (waitMs <= 0) return;
+        waitTicks = pdMS_TO_TICKS(waitMs);
+        if (waitTicks == 0) waitTicks = 1;
+    }
+    vTaskDelay(waitTicks);
+    wakeups++;
+
+    unsigned long idleUs = micros() - idleStartUs;
+    loopIdleMicros += idleUs;
+    windowLoopIdleMicros += idleUs;
+    sampleCpuIdle();
+}
+
+// Bezczynność CPU z licznika czasu pracy zadania idle (rdzeń, na którym działa
+// loop()). Licznik jest w sdkconfig tylko z CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS.
+// Różnice liczone na 32 bitach - próbka co najwyżej co kilkadziesiąt ms,
+// więc przepełnienie licznika nie psuje sumy.
+void Scheduler::sampleCpuIdle() {
+#if configGENERATE_RUN_TIME_STATS
+    uint32_t idle = (uint32_t)ulTaskGetIdleRunTimeCounter();
+    uint32_t total = (uint32_t)portGET_RUN_TIME_COUNTER_VALUE();
+    if (cpuSampled) {
+        uint32_t idleDelta = idle - lastCpuIdle;
+        uint32_t totalDelta = total - lastCpuTotal;
+        cpuIdleTime += idleDelta;
+        cpuTotalTime += totalDelta;
+        windowCpuIdleTime += idleDelta;
+        windowCpuTotalTime += totalDelta;
+    }
+    lastCpuIdle = idle;
+    lastCpuTotal = total;
+    cpuSampled = true;
+#endif
+}
+
+static void appendPct(TextBuffer& out, const char* key, uint64_t part, uint64_t total) {
+    if (total) out.appendf(",\"%s\":%u", key, (unsigned)(part * 100 / total));
+    else out.appendf(",\"%s\":null", key);
+}
+
+// Procenty liczone od poprzedniego odczytu oraz od startu. loopIdlePct to czas,
+// w którym wątek loop() czekał na termin (inne zadania mogły wtedy liczyć);
+// cpuIdlePct to czas zadania idle, null bez liczników czasu pracy FreeRTOS.
+void Scheduler::writeJson(TextBuffer& out) {
+    out.appendf("{\"wakeups\":%" PRIu32 ",\"tasksRun\":%" PRIu32 ",\"tasks\":%d,\"lightSleep\":%s",
+                wakeups, tasksRun, heapSize, lightSleepEnabled ? "true" : "false");
+    appendPct(out, "loopIdlePct", windowLoopIdleMicros, windowLoopIdleMicros + windowLoopBusyMicros);
+    appendPct(out, "loopIdlePctTotal", loopIdleMicros, loopIdleMicros + loopBusyMicros);
+    appendPct(out, "cpuIdlePct", windowCpuIdleTime, windowCpuTotalTime);
+    appendPct(out, "cpuIdlePctTotal", cpuIdleTime, cpuTotalTime);
+    out.append('}');
+    windowLoopIdleMicros = 0;
+    windowLoopBusyMicros = 0;
+    windowCpuIdleTime = 0;
+    windowCpuTotalTime = 0;
+}
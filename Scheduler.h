@@ -0,0 +1,70 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+#include "TextBuffer.h"
+
+typedef void (*TaskCallback)(void* arg);
+
+// Kooperacyjny planista zadań okresowych i jednorazowych dla loop().
+// Zadania trzymane są w kopcu minimalnym (stała tablica, bez alokacji);
+// run() wykonuje zadania, których termin minął, a potem blokuje wątek
+// loop() do najbliższego terminu. Nic poza terminem go nie budzi: sieć
+// (WWW, MQTT) jest odpytywana okresowo, a zmiany czujników obsługuje
+// zadanie pompy, samo odpytujące wejścia co 10 ms.
+// Wszystkie porównania czasu są odporne na przepełnienie millis().
+class Scheduler {
+public:
+    static const int MAX_TASKS = 16;
+
+    Scheduler();
+    void begin(bool lightSleep = true);
+    int every(unsigned long periodMs, TaskCallback callback, void* arg = nullptr);
+    int after(unsigned long delayMs, TaskCallback callback, void* arg = nullptr);
+    void cancel(int id);
+    void run();
+
+    void writeJson(TextBuffer& out);
+    bool isLightSleepEnabled() const { return lightSleepEnabled; }
+
+private:
+    struct Task {
+        TaskCallback callback = nullptr;
+        void* arg = nullptr;
+        unsigned long period = 0; // 0 = zadanie jednorazowe
+        unsigned long deadline = 0;
+    };
+
+    int add(unsigned long delayMs, unsigned long periodMs, TaskCallback callback, void* arg);
+    bool before(int a, int b) const;
+    void swapNodes(int i, int j);
+    void siftUp(int i);
+    void siftDown(int i);
+    void removeAt(int i);
+    bool enableLightSleep();
+    void sampleCpuIdle();
+
+    Task tasks[MAX_TASKS];
+    int heap[MAX_TASKS];     // indeksy zadań uporządkowane wg terminu
+    int heapPos[MAX_TASKS];  // pozycja zadania w kopcu, -1 = wolny slot
+    int heapSize = 0;
+    bool lightSleepEnabled = false;
+
+    // Statystyki obciążenia
+    uint32_t wakeups = 0;
+    uint32_t tasksRun = 0;
+    uint64_t loopIdleMicros = 0; // loop() czeka na termin
+    uint64_t loopBusyMicros = 0;
+    uint64_t windowLoopIdleMicros = 0;
+    uint64_t windowLoopBusyMicros = 0;
+    // Liczniki czasu pracy FreeRTOS (jednostka portu): zadanie idle i cały czas
+    uint64_t cpuIdleTime = 0;
+    uint64_t cpuTotalTime = 0;
+    uint64_t windowCpuIdleTime = 0;
+    uint64_t windowCpuTotalTime = 0;
+    uint32_t lastCpuIdle = 0;
+    uint32_t lastCpuTotal = 0;
+    bool cpuSampled = false;
+};
+
+#endif
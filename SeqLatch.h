@@ -0,0 +1,45 @@
+#ifndef SEQ_LATCH_H
+#define SEQ_LATCH_H
+
+#include <atomic>
+#include <stdint.h>
+
+// Wersjonowana migawka stanu z jednym zapisującym i dowolną liczbą czytelników.
+// Zatrzask sekwencyjny z dwiema kopiami danych: zapis aktualizuje kolejno obie
+// kopie, a czytelnik zawsze trafia w tę, której zapis właśnie nie dotyka -
+// nie czeka na zapisującego, a co najwyżej powtarza kopiowanie, gdy ten
+// w międzyczasie zaczął kolejną publikację. Bezpieczne między zadaniami
+// FreeRTOS niezależnie od ich priorytetów. Nie do użycia w ISR jako zapis.
+template <typename T>
+class SeqLatch {
+public:
+    // Tylko jeden zapisujący (właściciel stanu)
+    void publish(const T& value) {
+        uint32_t s = seq.load(std::memory_order_relaxed);
+        seq.store(s + 1, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_release);
+        slots[0] = value;
+        seq.store(s + 2, std::memory_order_release);
+        slots[1] = value;
+    }
+
+    // Kopiuje spójną migawkę, zwraca jej wersję
+    uint32_t read(T& out) const {
+        for (;;) {
+            uint32_t s = seq.load(std::memory_order_acquire);
+            out = slots[s & 1];
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq.load(std::memory_order_relaxed) == s) return s >> 1;
+        }
+    }
+
+    // Liczba zakończonych publikacji - tani test "zmieniło się od wersji N"
+    uint32_t version() const { return seq.load(std::memory_order_acquire) >> 1; }
+    bool changedSince(uint32_t v) const { return version() != v; }
+
+private:
+    std::atomic<uint32_t> seq{0};
+    T slots[2] = {};
+};
+
+#endif
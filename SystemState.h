@@ -2,35 +2,56 @@
 #define SYSTEM_STATE_H
 
 #include <Arduino.h>
+#include <stdarg.h>
+#include "HeapMonitor.h"
+#include "Logger.h"
+#include "SeqLatch.h"
 
 #define EVENT_LIMIT 20
+#define EVENT_TEXT_LEN 96
 
-struct SystemState {
-    // Stan sprzętowy
+// Stan sprzętowy i tryby pracy - jedyny zapisujący to zadanie sterujące pompy
+struct ControlState {
     bool pumpOn = false;
     bool sensorLowState = false;
     bool sensorMidState = false;
     bool sensorHighState = false;
     int waterLevel = 0;
-
-    // Tryby pracy
     bool manualMode = false;
     bool testMode = false;
     unsigned long manualModeStartTime = 0;
+    bool midSensorPresent = false;
+    uint8_t rawInputs = 0; // odczyt czujników bez nadpisania trybu testowego (bity PUMP_IN_*)
+};
+
+struct SystemState {
+    // Niezmienne migawki stanu sterowania; zmiany wyłącznie przez polecenia PumpController
+    SeqLatch<ControlState> control;
     const unsigned long manualModeTimeout = 30 * 60 * 1000; // 30 minut
 
-    // Stan połączeń
+    // Stan połączeń (zapisywany tylko z wątku loop())
     bool wifiConnected = false;
 
-    // Zdarzenia
-    String events[EVENT_LIMIT];
+    // Zdarzenia (stałe bufory - brak alokacji przy każdym wpisie)
+    char events[EVENT_LIMIT][EVENT_TEXT_LEN] = {};
     int eventIndex = 0;
 
-    void addEvent(String msg) {
-        Serial.println(msg);
-        events[eventIndex] = msg;
+    void addEvent(const char* msg) {
+        HeapScope scope(HEAP_EVENTS);
+        logger.info(LOG_EVENT, "%s", msg);
+        strlcpy(events[eventIndex], msg, EVENT_TEXT_LEN);
         eventIndex = (eventIndex + 1) % EVENT_LIMIT;
     }
+
+    __attribute__((format(printf, 2, 3)))
+    void addEventf(const char* fmt, ...) {
+        char msg[EVENT_TEXT_LEN];
+        va_list args;
+        va_start(args, fmt);
+        vsnprintf(msg, sizeof(msg), fmt, args);
+        va_end(args);
+        addEvent(msg);
+    }
 };
 
 #endif
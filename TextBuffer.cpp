@@ -0,0 +1,78 @@
+#include "TextBuffer.h"
+#include <stdarg.h>
+
+TextBuffer::TextBuffer(char* buffer, size_t capacity) : buf(buffer), cap(capacity) {
+    if (cap > 0) buf[0] = '\0';
+}
+
+void TextBuffer::clear() {
+    len = 0;
+    overflow = false;
+    if (cap > 0) buf[0] = '\0';
+}
+
+TextBuffer& TextBuffer::append(const char* str, size_t n) {
+    if (cap == 0) return *this;
+    size_t room = cap - 1 - len;
+    if (n > room) {
+        n = room;
+        overflow = true;
+    }
+    memcpy(buf + len, str, n);
+    len += n;
+    buf[len] = '\0';
+    return *this;
+}
+
+TextBuffer& TextBuffer::append(const char* str) {
+    return str ? append(str, strlen(str)) : *this;
+}
+
+TextBuffer& TextBuffer::append(char c) {
+    return append(&c, 1);
+}
+
+TextBuffer& TextBuffer::append(long value) {
+    char tmp[12];
+    int n = snprintf(tmp, sizeof(tmp), "%ld", value);
+    return append(tmp, (size_t)n);
+}
+
+TextBuffer& TextBuffer::append(unsigned long value) {
+    char tmp[12];
+    int n = snprintf(tmp, sizeof(tmp), "%lu", value);
+    return append(tmp, (size_t)n);
+}
+
+TextBuffer& TextBuffer::appendf(const char* fmt, ...) {
+    if (cap == 0) return *this;
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf + len, cap - len, fmt, args);
+    va_end(args);
+    if (n < 0) return *this;
+    if ((size_t)n >= cap - len) {
+        overflow = true;
+        len = cap - 1;
+    } else {
+        len += n;
+    }
+    return *this;
+}
+
+// Kodowanie application/x-www-form-urlencoded bajt po bajcie (UTF-8 przechodzi jako %XX)
+TextBuffer& TextBuffer::appendUrlEncoded(const char* str) {
+    static const char hex[] = "0123456789ABCDEF";
+    for (const unsigned char* p = (const unsigned char*)str; *p; p++) {
+        if (*p == ' ') {
+            append('+');
+        } else if (isalnum(*p)) {
+            append((char)*p);
+        } else {
+            char code[3] = { '%', hex[*p >> 4], hex[*p & 0xf] };
+            append(code, sizeof(code));
+        }
+        if (overflow) break;
+    }
+    return *this;
+}
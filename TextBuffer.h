@@ -0,0 +1,35 @@
+#ifndef TEXT_BUFFER_H
+#define TEXT_BUFFER_H
+
+#include <Arduino.h>
+
+// Ograniczony bufor tekstowy na pamięci dostarczonej przez wywołującego
+// (stos lub pole klasy). Nigdy nie alokuje - nadmiar jest obcinany, a flaga
+// truncated() pozwala wykryć zbyt mały bufor.
+class TextBuffer {
+public:
+    TextBuffer(char* buffer, size_t capacity);
+
+    TextBuffer& append(const char* str);
+    TextBuffer& append(const char* str, size_t len);
+    TextBuffer& append(char c);
+    TextBuffer& append(long value);
+    TextBuffer& append(unsigned long value);
+    TextBuffer& append(int value) { return append((long)value); }
+    TextBuffer& appendf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+    TextBuffer& appendUrlEncoded(const char* str);
+
+    void clear();
+    const char* c_str() const { return buf; }
+    size_t length() const { return len; }
+    size_t capacity() const { return cap; }
+    bool truncated() const { return overflow; }
+
+private:
+    char* buf;
+    size_t cap;
+    size_t len = 0;
+    bool overflow = false;
+};
+
+#endif
@@ -1,12 +1,45 @@
 #include "WaterMonitorMQTT.h"
+#include "CborWriter.h"
+#include <inttypes.h>
+
+// Klucze rekordu CBOR (schemat opisany w README)
+enum CompactKey : uint8_t {
+    KEY_SCHEMA = 0,
+    KEY_SEQ = 1,
+    KEY_UPTIME_MS = 2,
+    KEY_LEVEL = 3,
+    KEY_SENSORS = 4,
+    KEY_PUMP = 5,
+    KEY_MODE = 6
+};
+
+// Tryb w obu formatach; tryb testowy włącza też ręczny, więc "manual" ma
+// pierwszeństwo (tak publikował format tekstowy od początku)
+enum TelemetryMode : uint8_t {
+    MODE_AUTO = 0,
+    MODE_MANUAL = 1,
+    MODE_TEST = 2
+};
+
+static const char* const MODE_NAMES[] = { "auto", "manual", "test" };
+
+static uint8_t changeKey(const ControlState& state);
+
+static const uint8_t COMPACT_SCHEMA = 1;
+static const uint8_t COMPACT_MID_PRESENT = 0x10;
 
 WaterMonitorMQTT::WaterMonitorMQTT() : 
     mqttClient(espClient), 
     mqttPort(1883),
     mqttClientId("esp32-water-monitor"),
     mqttBaseTopic("homeassistant/sensor/water_monitor/"),
-    lastReconnectAttempt(0),
-    lastDataSend(0) {
+    lastReconnectAttempt(0) {
+    snprintf(pumpSetTopic, sizeof(pumpSetTopic), "%spump/set", mqttBaseTopic);
+    setNodeName("water_monitor");
+}
+
+void WaterMonitorMQTT::setNodeName(const char* nodeName) {
+    snprintf(compactTopic, sizeof(compactTopic), "wm/%s", nodeName);
 }
 
 void WaterMonitorMQTT::begin(Preferences& prefs) {
@@ -19,25 +52,13 @@ void WaterMonitorMQTT::begin(Preferences& prefs) {
     }
 }
 
-void WaterMonitorMQTT::setPins(int lowPin, int highPin, int midPin, int relayPin) {
-    sensorLowPin = lowPin;
-    sensorHighPin = highPin;
-    sensorMidPin = midPin;
-    relayControlPin = relayPin;
-}
-
-void WaterMonitorMQTT::setWaterStates(bool* pumpOn, bool* manualMode, bool* testMode) {
-    pumpState = pumpOn;
-    manualModeState = manualMode;
-    testModeState = testMode;
-}
-
 void WaterMonitorMQTT::loadConfig(Preferences& prefs) {
     prefs.begin("mqtt", true);
     mqttServer = prefs.getString("server", "");
     mqttPort = prefs.getInt("port", 1883);
     mqttUser = prefs.getString("user", "");
     mqttPassword = prefs.getString("pass", "");
+    compactFormat = prefs.getBool("cbor", false);
     prefs.end();
 }
 
@@ -47,6 +68,7 @@ void WaterMonitorMQTT::saveConfig(Preferences& prefs) {
     prefs.putInt("port", mqttPort);
     prefs.putString("user", mqttUser);
     prefs.putString("pass", mqttPassword);
+    prefs.putBool("cbor", compactFormat);
     prefs.end();
 }
 
@@ -54,58 +76,159 @@ void WaterMonitorMQTT::reconnect() {
     if (millis() - lastReconnectAttempt < 5000) return;
     
     lastReconnectAttempt = millis();
-    Serial.println("Attempting MQTT connection...");
+    logger.debug(LOG_MQTT, "Łączenie z brokerem %s:%d", mqttServer.c_str(), mqttPort);
     
     if (mqttClient.connect(mqttClientId.c_str(), mqttUser.c_str(), mqttPassword.c_str())) {
-        Serial.println("Connected to MQTT broker");
+        logger.info(LOG_MQTT, "Połączono z brokerem MQTT");
         // Subskrypcja tematów jeśli potrzebne
-        mqttClient.subscribe((mqttBaseTopic + "pump/set").c_str());
+        mqttClient.subscribe(pumpSetTopic);
     } else {
-        Serial.print("Failed, rc=");
-        Serial.print(mqttClient.state());
-        Serial.println(" try again in 5 seconds");
+        logger.warn(LOG_MQTT, "Błąd połączenia, rc=%d - ponowna próba za 5 s", mqttClient.state());
     }
 }
 
+// Pełny temat składany w buforze klasy - ważny do następnego wywołania
+const char* WaterMonitorMQTT::topic(const char* suffix) {
+    snprintf(topicBuffer, sizeof(topicBuffer), "%s%s", mqttBaseTopic, suffix);
+    return topicBuffer;
+}
+
+static bool payloadEquals(const byte* payload, unsigned int length, const char* expected) {
+    return length == strlen(expected) && memcmp(payload, expected, length) == 0;
+}
+
 void WaterMonitorMQTT::mqttCallback(char* topic, byte* payload, unsigned int length) {
-    String message;
-    for (unsigned int i = 0; i < length; i++) {
-        message += (char)payload[i];
-    }
-    
-    String topicStr(topic);
-    if (topicStr == mqttBaseTopic + "pump/set") {
-        if (message == "ON") {
-            digitalWrite(relayControlPin, HIGH);
-            *pumpState = true;
-        } else if (message == "OFF") {
-            digitalWrite(relayControlPin, LOW);
-            *pumpState = false;
+    HeapScope scope(HEAP_MQTT);
+    if (strcmp(topic, pumpSetTopic) == 0 && pumpController) {
+        if (payloadEquals(payload, length, "ON")) {
+            pumpController->sendCommand(PUMP_CMD_SET, PUMP_SRC_MQTT, true);
+        } else if (payloadEquals(payload, length, "OFF")) {
+            pumpController->sendCommand(PUMP_CMD_SET, PUMP_SRC_MQTT, false);
         }
     }
 }
 
+// Rozmiar pakietu PUBLISH QoS 0: nagłówek, długość (varint), temat, dane
+static size_t publishPacketSize(size_t topicLength, size_t payloadLength) {
+    size_t remaining = 2 + topicLength + payloadLength;
+    size_t lengthBytes = remaining < 128 ? 1 : (remaining < 16384 ? 2 : 3);
+    return 1 + lengthBytes + remaining;
+}
+
+size_t WaterMonitorMQTT::publish(const char* topic, const uint8_t* payload, size_t length, bool send) {
+    if (send) mqttClient.publish(topic, payload, length);
+    return publishPacketSize(strlen(topic), length);
+}
+
+size_t WaterMonitorMQTT::publish(const char* topic, const char* payload, bool send) {
+    return publish(topic, (const uint8_t*)payload, strlen(payload), send);
+}
+
 void WaterMonitorMQTT::sendData() {
-    if (!mqttClient.connected()) return;
-    
-    bool low = digitalRead(sensorLowPin) == LOW;
-    bool high = digitalRead(sensorHighPin) == LOW;
-    bool mid = (sensorMidPin != -1) ? (digitalRead(sensorMidPin) == LOW) : false;
-    
-    int waterLevel = 0;
-    if (high) waterLevel = 100;
-    else if (mid) waterLevel = 65;
-    else if (low) waterLevel = 30;
-    else waterLevel = 5;
-
-    mqttClient.publish((mqttBaseTopic + "level").c_str(), String(waterLevel).c_str());
-    mqttClient.publish((mqttBaseTopic + "pump").c_str(), *pumpState ? "ON" : "OFF");
-    mqttClient.publish((mqttBaseTopic + "mode").c_str(), *manualModeState ? "manual" : (*testModeState ? "test" : "auto"));
-    mqttClient.publish((mqttBaseTopic + "low_sensor").c_str(), low ? "WET" : "DRY");
-    mqttClient.publish((mqttBaseTopic + "high_sensor").c_str(), high ? "WET" : "DRY");
-    if (sensorMidPin != -1) {
-        mqttClient.publish((mqttBaseTopic + "mid_sensor").c_str(), mid ? "WET" : "DRY");
+    if (!mqttClient.connected() || !stateSource) return;
+    HeapScope scope(HEAP_MQTT);
+
+    ControlState state;
+    publishedVersion = stateSource->read(state);
+    publishedKey = changeKey(state);
+    sequence++;
+
+    // Rozmiar liczony dla obu formatów, wysyłany tylko wybrany
+    bytesReadable += publishReadable(state, !compactFormat);
+    bytesCompact += publishCompact(state, compactFormat);
+    publishCount++;
+}
+
+// Wartości wyliczane tak samo dla obu formatów - most CBOR odtwarza z nich
+// dokładnie format tekstowy. Poziom z surowego odczytu czujników (bez
+// nadpisania trybu testowego).
+static uint8_t telemetryLevel(const ControlState& state) {
+    if (state.rawInputs & PUMP_IN_HIGH) return 100;
+    if (state.rawInputs & PUMP_IN_MID) return 65;
+    if (state.rawInputs & PUMP_IN_LOW) return 30;
+    return 5;
+}
+
+static TelemetryMode telemetryMode(const ControlState& state) {
+    if (state.manualMode) return MODE_MANUAL;
+    return state.testMode ? MODE_TEST : MODE_AUTO;
+}
+
+// Pola, których zmiana publikowana jest od razu: pompa, tryb i czujniki po
+// debouncingu. rawInputs pomijamy - drgają przy falowaniu lustra wody.
+static uint8_t changeKey(const ControlState& state) {
+    return (state.pumpOn ? 0x01 : 0) | telemetryMode(state) << 1 | (state.sensorLowState ? 0x08 : 0) |
+           (state.sensorMidState ? 0x10 : 0) | (state.sensorHighState ? 0x20 : 0);
+}
+
+size_t WaterMonitorMQTT::publishReadable(const ControlState& state, bool send) {
+    bool low = state.rawInputs & PUMP_IN_LOW;
+    bool high = state.rawInputs & PUMP_IN_HIGH;
+    bool mid = state.rawInputs & PUMP_IN_MID;
+
+    char levelStr[4];
+    snprintf(levelStr, sizeof(levelStr), "%u", telemetryLevel(state));
+
+    size_t bytes = 0;
+    bytes += publish(topic("level"), levelStr, send);
+    bytes += publish(topic("pump"), state.pumpOn ? "ON" : "OFF", send);
+    bytes += publish(topic("mode"), MODE_NAMES[telemetryMode(state)], send);
+    bytes += publish(topic("low_sensor"), low ? "WET" : "DRY", send);
+    bytes += publish(topic("high_sensor"), high ? "WET" : "DRY", send);
+    if (state.midSensorPresent) {
+        bytes += publish(topic("mid_sensor"), mid ? "WET" : "DRY", send);
     }
+    return bytes;
+}
+
+size_t WaterMonitorMQTT::publishCompact(const ControlState& state, bool send) {
+    uint8_t buf[32];
+    CborWriter cbor(buf, sizeof(buf));
+    cbor.writeMap(7);
+    cbor.writeUInt(KEY_SCHEMA);
+    cbor.writeUInt(COMPACT_SCHEMA);
+    cbor.writeUInt(KEY_SEQ);
+    cbor.writeUInt(sequence);
+    cbor.writeUInt(KEY_UPTIME_MS);
+    cbor.writeUInt(millis());
+    cbor.writeUInt(KEY_LEVEL);
+    cbor.writeUInt(telemetryLevel(state));
+    cbor.writeUInt(KEY_SENSORS);
+    cbor.writeUInt(state.rawInputs | (state.midSensorPresent ? COMPACT_MID_PRESENT : 0));
+    cbor.writeUInt(KEY_PUMP);
+    cbor.writeBool(state.pumpOn);
+    cbor.writeUInt(KEY_MODE);
+    cbor.writeUInt(telemetryMode(state));
+    return publish(compactTopic, cbor.data(), cbor.length(), send);
+}
+
+// Stała migawka - wynik pomiaru nie zależy od bieżącego stanu czujników
+static ControlState benchmarkState() {
+    ControlState state;
+    state.pumpOn = true;
+    state.sensorLowState = true;
+    state.sensorMidState = true;
+    state.waterLevel = 65;
+    state.midSensorPresent = true;
+    state.rawInputs = PUMP_IN_LOW | PUMP_IN_MID;
+    return state;
+}
+
+size_t WaterMonitorMQTT::benchmarkPublish(bool compact) {
+    static const ControlState state = benchmarkState();
+    return compact ? publishCompact(state, false) : publishReadable(state, false);
+}
+
+size_t WaterMonitorMQTT::benchmarkCallback() {
+    // Właściwy temat, nieznana wartość - pełna ścieżka bez polecenia dla pompy
+    static const byte payload[] = { 'N', 'O', 'O', 'P' };
+    mqttCallback(pumpSetTopic, (byte*)payload, sizeof(payload));
+    return 0;
+}
+
+void WaterMonitorMQTT::writeJson(TextBuffer& out) const {
+    out.appendf("{\"format\":\"%s\",\"publishCycles\":%" PRIu32 ",\"bytesText\":%" PRIu32 ",\"bytesCbor\":%" PRIu32 "}",
+                compactFormat ? "cbor" : "text", publishCount, bytesReadable, bytesCompact);
 }
 
 void WaterMonitorMQTT::loop() {
@@ -115,10 +238,32 @@ void WaterMonitorMQTT::loop() {
         reconnect();
     } else {
         mqttClient.loop();
-        
-        if (millis() - lastDataSend > 10000) { // Co 10 sekund
-            sendData();
-            lastDataSend = millis();
+
+        // Zmiana pompy, trybu lub poziomu trafia do brokera od razu, nie po 10 s
+        // (nie częściej niż co sekundę)
+        if (stateSource && stateSource->changedSince(publishedVersion) && millis() - lastChangePublish >= 1000) {
+            ControlState state;
+            uint32_t version = stateSource->read(state);
+            if (changeKey(state) != publishedKey) {
+                lastChangePublish = millis();
+                sendData();
+            } else {
+                publishedVersion = version; // tylko surowe bity czujników
+            }
         }
+        publishLogs();
+    }
+}
+
+// Ujście MQTT loggera: kilka wpisów na wywołanie, by nie blokować pętli
+void WaterMonitorMQTT::publishLogs() {
+    LogRecord record;
+    char line[LOG_TEXT_LEN + 32];
+    char logTopic[sizeof(compactTopic) + 4];
+    snprintf(logTopic, sizeof(logTopic), "%s/log", compactTopic);
+    for (int i = 0; i < 4 && logger.nextMqttRecord(record); i++) {
+        TextBuffer payload(line, sizeof(line));
+        payload.appendf("%c %s: %s", Logger::levelChar(record.level), Logger::moduleName(record.module), record.text);
+        publish(logTopic, (const uint8_t*)payload.c_str(), payload.length(), true);
     }
 }
\ No newline at end of file
@@ -4,13 +4,18 @@
 #include <WiFi.h>
 #include <PubSubClient.h>
 #include <Preferences.h>
+#include "HeapMonitor.h"
+#include "Logger.h"
+#include "PumpController.h"
+#include "TextBuffer.h"
 
 class WaterMonitorMQTT {
 public:
     WaterMonitorMQTT();
     void begin(Preferences& prefs);
-    void setPins(int lowPin, int highPin, int midPin, int relayPin);
-    void setWaterStates(bool* pumpOn, bool* manualMode, bool* testMode);
+    void setStateSource(const SeqLatch<ControlState>* source) { stateSource = source; }
+    void setPumpController(PumpController* pump) { pumpController = pump; }
+    void setNodeName(const char* nodeName);
     void loop();
     void sendData();
     bool isConnected() { return mqttClient.connected(); }
@@ -19,20 +24,35 @@ public:
     int getPort() const { return mqttPort; }
     String getUser() const { return mqttUser; }
     String getPassword() const { return mqttPassword; }
+    bool isCompactFormat() const { return compactFormat; }
     
-    void setConfig(String server, int port, String user, String pass) {
+    void setConfig(String server, int port, String user, String pass, bool compact) {
         mqttServer = server;
         mqttPort = port;
         mqttUser = user;
         mqttPassword = pass;
+        compactFormat = compact;
     }
 
     void saveConfig(Preferences& prefs);
+    void writeJson(TextBuffer& out) const;
+
+    // Pomiar (/bench): formatowanie publikacji i callback na stałych danych, bez wysyłki
+    size_t benchmarkPublish(bool compact);
+    size_t benchmarkCallback();
+    // Numeracja rekordów od zera - rozmiar CBOR (seq) nie zależy od liczby wywołań
+    void restartSequence() { sequence = 0; }
 
 private:
     void reconnect();
     void mqttCallback(char* topic, byte* payload, unsigned int length);
     void loadConfig(Preferences& prefs);
+    void publishLogs();
+    const char* topic(const char* suffix);
+    size_t publishReadable(const ControlState& state, bool send);
+    size_t publishCompact(const ControlState& state, bool send);
+    size_t publish(const char* topic, const char* payload, bool send);
+    size_t publish(const char* topic, const uint8_t* payload, size_t length, bool send);
 
     WiFiClient espClient;
     PubSubClient mqttClient;
@@ -42,21 +62,30 @@ private:
     String mqttUser;
     String mqttPassword;
     String mqttClientId;
-    String mqttBaseTopic;
+    const char* mqttBaseTopic;
+    char topicBuffer[64];
+    char pumpSetTopic[64];
+    char compactTopic[32];
+
+    // Format kompaktowy: jeden PUBLISH z rekordem CBOR zamiast sześciu tematów
+    bool compactFormat = false;
+    uint32_t sequence = 0;
+    uint32_t publishCount = 0;
+    uint32_t bytesReadable = 0; // rozmiar pakietów PUBLISH w formacie tekstowym
+    uint32_t bytesCompact = 0;  // ... i w formacie CBOR (liczone zawsze dla obu)
 
-    // Referencje do stanu z głównego programu
-    bool* pumpState;
-    bool* manualModeState;
-    bool* testModeState;
+    // Migawki stanu sterowania; poza publikacją co 10 s także od razu po zmianie
+    // pompy, trybu lub poziomu po debouncingu (changeKey) - same surowe bity
+    // czujników (falowanie lustra wody) czekają na publikację okresową
+    const SeqLatch<ControlState>* stateSource = nullptr;
+    uint32_t publishedVersion = 0;
+    uint8_t publishedKey = 0xff;
+    unsigned long lastChangePublish = 0;
     
-    // Piny czujników
-    int sensorLowPin;
-    int sensorHighPin;
-    int sensorMidPin;
-    int relayControlPin;
+    // Polecenia pompy trafiają do kolejki zadania sterującego
+    PumpController* pumpController = nullptr;
 
     unsigned long lastReconnectAttempt;
-    unsigned long lastDataSend;
 };
 
 #endif
\ No newline at end of file
@@ -1,14 +1,85 @@
 #include "WebInterface.h"
 #include <Update.h>
 #include <ESPmDNS.h>
+#include <inttypes.h>
+
+// Statyczne fragmenty strony - wysyłane wprost z flash, bez kopiowania do String
+static const char PAGE_HEAD[] PROGMEM = R"rawliteral(
+    <!DOCTYPE html>
+    <html lang="pl">
+    <head>
+      <meta charset="UTF-8"><meta name="viewport" content="width=device-width, initial-scale=1.0">
+      <title>System Zbiornika Wody</title>
+      <link href="https://fonts.googleapis.com/css2?family=Roboto:wght@300;400;500;700&display=swap" rel="stylesheet">
+      <link href="https://cdnjs.cloudflare.com/ajax/libs/font-awesome/5.15.4/css/all.min.css" rel="stylesheet">
+      <style>
+        :root { --primary: #3498db; --secondary: #2ecc71; --danger: #e74c3c; --warning: #f39c12; --dark: #2c3e50; --light: #ecf0f1; }
+        body { font-family: 'Roboto', sans-serif; background-color: #f5f7fa; color: #333; margin: 0; padding: 20px; }
+        .container { max-width: 1000px; margin: 0 auto; background: white; border-radius: 15px; box-shadow: 0 5px 15px rgba(0,0,0,0.1); overflow: hidden; }
+        header { background: linear-gradient(135deg, var(--primary), var(--dark)); color: white; padding: 20px; text-align: center; }
+        .badge { display: inline-block; padding: 5px 10px; border-radius: 20px; font-size: 14px; margin-top: 10px; font-weight: 500; }
+        .test-mode { background-color: var(--warning); color: white; }
+        .manual-mode { background-color: var(--primary); color: white; }
+        .dashboard { display: grid; grid-template-columns: 2fr 1fr; gap: 20px; padding: 20px; }
+        @media (max-width: 768px) { .dashboard { grid-template-columns: 1fr; } }
+        .tank-container { background: white; border-radius: 10px; padding: 20px; box-shadow: 0 3px 10px rgba(0,0,0,0.05); }
+        .tank { position: relative; max-width: 300px; margin: 0 auto; width: 100%; height: 300px; background: #e0f2fe; border-radius: 5px; overflow: hidden; border: 3px solid #b3e0ff; }
+        .water { position: absolute; bottom: 0; width: 100%; background: linear-gradient(to top, #3b82f6, #60a5fa); transition: height 0.5s ease; }
+        .sensor { position: absolute; left: 10px; width: calc(100% - 20px); height: 3px; background: var(--dark); border-radius: 3px; }
+        .sensor::after { content: ''; position: absolute; right: -15px; top: -5px; width: 10px; height: 10px; border-radius: 50%; }
+        .sensor.high { top: 10%; }
+        .sensor.mid { top: 35%; }
+        .sensor.low { top: 70%; }
+        .sensor-label { position: absolute; right: -80px; top: -10px; font-size: 14px; font-weight: 500; white-space: nowrap; }
+        .water-percentage { position: absolute; top: 50%; left: 50%; transform: translate(-50%, -50%); font-size: 24px; font-weight: 700; color: rgba(255,255,255,0.8); text-shadow: 0 2px 4px rgba(0,0,0,0.3); }
+        .status-indicator { display: flex; align-items: center; margin-bottom: 10px; }
+        .status-dot { width: 12px; height: 12px; border-radius: 50%; margin-right: 10px; }
+        .status-on { background-color: var(--secondary); }
+        .status-off { background-color: var(--danger); }
+        .nav { display: flex; justify-content: space-around; background: var(--light); padding: 15px; border-radius: 10px; margin-top: 20px; }
+        .nav a { color: var(--dark); text-decoration: none; font-weight: 500; transition: color 0.3s; }
+        .nav a:hover { color: var(--primary); }
+        .control-panel { background: white; border-radius: 10px; padding: 20px; box-shadow: 0 3px 10px rgba(0,0,0,0.05); }
+      </style>
+    </head>
+    <body><div class="container"><header><h1><i class="fas fa-tint"></i> System Zbiornika Wody</h1>
+    )rawliteral";
+
+static const char PAGE_FOOT[] PROGMEM = R"rawliteral(
+        </div></div></div>
+        <div class="nav">
+            <a href="/"><i class="fas fa-home"></i> Strona Główna</a>
+            <a href="/manual"><i class="fas fa-hand-paper"></i> Sterowanie</a>
+            <a href="/config"><i class="fas fa-sliders-h"></i> Konfiguracja</a>
+            <a href="/mqtt_config"><i class="fas fa-cloud"></i> MQTT</a>
+            <a href="/log"><i class="fas fa-history"></i> Historia</a>
+            <a href="/log_config"><i class="fas fa-terminal"></i> Logi</a>
+            <a href="/fleet"><i class="fas fa-network-wired"></i> Flota</a>
+        </div>
+    </div></body></html>
+    )rawliteral";
+
+static const char* sensorColor(bool wet) {
+    return wet ? "var(--secondary)" : "var(--danger)";
+}
+
+static const char* statusDot(bool on) {
+    return on ? "status-on" : "status-off";
+}
+
+// Wpis historii renderowany podczas pomiaru zamiast bieżących zdarzeń
+static const char BENCH_EVENT[] = "Automatyczne włączenie pompy (brak wody)";
 
 // Konstruktor: inicjalizuje referencje i obiekty
-WebInterface::WebInterface(SystemState& state, WaterMonitorMQTT& mqtt, PumpController& pump, Preferences& prefs)
+WebInterface::WebInterface(SystemState& state, WaterMonitorMQTT& mqtt, PumpController& pump, Preferences& prefs, Scheduler& sched, Fleet& fleet)
     : server(80),
       systemState(state),
       waterMQTT(mqtt),
       pumpController(pump),
-      preferences(prefs) {
+      preferences(prefs),
+      scheduler(sched),
+      fleet(fleet),
+      benchmark(prefs) {
 }
 
 // Metoda do ładowania konfiguracji potrzebnej DLA interfejsu (piny, hasła itp.)
@@ -24,12 +95,17 @@ void WebInterface::loadLocalConfig() {
     pass = preferences.getString("pass", "");
     pushoverToken = preferences.getString("pushtoken", "");
     pushoverUser = preferences.getString("pushuser", "");
+    nodeName = preferences.getString("nodeName", "");
+    fleetAggregator = preferences.getBool("aggregator", false);
+    adaptivePump = preferences.getBool("adaptive", false);
+    peakHours = preferences.getUInt("peakHours", 0);
     preferences.end();
 }
 
 // Rejestracja wszystkich ścieżek (URL) serwera
 void WebInterface::begin() {
     loadLocalConfig(); // Załaduj konfigurację pinów/haseł przy starcie serwera
+    benchmark.begin();
 
     server.on("/", HTTP_GET, [this](){ this->handleStatus(); });
     server.on("/manual", HTTP_GET, [this](){ this->handleManual(); });
@@ -37,8 +113,14 @@ void WebInterface::begin() {
     server.on("/config", HTTP_GET, [this](){ this->handleConfigForm(); });
     server.on("/save", HTTP_POST, [this](){ this->handleSave(); });
     server.on("/log", HTTP_GET, [this](){ this->handleLog(); });
+    server.on("/stats", HTTP_GET, [this](){ this->handleStats(); });
+    server.on("/fleet", HTTP_GET, [this](){ this->handleFleet(); });
+    server.on("/api/fleet", HTTP_GET, [this](){ this->handleFleetApi(); });
+    server.on("/bench", HTTP_GET, [this](){ this->handleBench(); });
     server.on("/mqtt_config", HTTP_GET, [this](){ this->handleMQTTConfig(); });
     server.on("/save_mqtt", HTTP_GET, [this](){ this->handleSaveMQTT(); }); // Używamy GET, bo formularz wysyła GET
+    server.on("/log_config", HTTP_GET, [this](){ this->handleLogConfig(); });
+    server.on("/save_log", HTTP_GET, [this](){ this->handleSaveLog(); });
     
     // Obsługa aktualizacji OTA
     server.on("/update", HTTP_POST,
@@ -64,39 +146,150 @@ void WebInterface::handleStatus() {
 }
 
 void WebInterface::handleLog() {
-    String content = "<div class='control-panel'><h3><i class='fas fa-history'></i> Historia Zdarzeń</h3><ul style='list-style-type:none; padding-left:10px;'>";
+    // Zdarzenia są strumieniowane bezpośrednio ze stałych buforów SystemState
+    sendPageHeader();
+    emit_P(PSTR("<div class='control-panel'><h3><i class='fas fa-history'></i> Historia Zdarzeń</h3><ul style='list-style-type:none; padding-left:10px;'>"));
     for (int i = 0; i < EVENT_LIMIT; i++) {
-        int idx = (systemState.eventIndex + i) % EVENT_LIMIT;
-        if (systemState.events[idx] != "") {
-            content += "<li><i class='fas fa-angle-right' style='color:var(--primary); margin-right:5px;'></i>" + systemState.events[idx] + "</li>";
+        // Podczas pomiaru pełna historia stałych wpisów - rozmiar nie zależy od bieżącej
+        const char* event = benchmarkMode ? BENCH_EVENT : systemState.events[(systemState.eventIndex + i) % EVENT_LIMIT];
+        if (event[0] != '\0') {
+            TextBuffer chunk(pageBuffer, sizeof(pageBuffer));
+            chunk.append("<li><i class='fas fa-angle-right' style='color:var(--primary); margin-right:5px;'></i>")
+                 .append(event).append("</li>");
+            emit(chunk.c_str(), chunk.length());
         }
     }
-    content += "</ul></div>";
-    sendPage(content);
+    emit_P(PSTR("</ul></div>"));
+    sendPageFooter();
+}
+
+void WebInterface::handleStats() {
+    heapMonitor.sample();
+    TextBuffer json(pageBuffer, sizeof(pageBuffer));
+    json.append("{\"heap\":");
+    heapMonitor.writeJson(json);
+    json.append(",\"scheduler\":");
+    scheduler.writeJson(json);
+    json.append(",\"control\":");
+    pumpController.writeJson(json);
+    json.append(",\"cycles\":");
+    pumpController.writeCyclesJson(json);
+    json.appendf(",\"stateVersion\":%" PRIu32, systemState.control.version());
+    json.append(",\"mqtt\":");
+    waterMQTT.writeJson(json);
+    json.append(",\"fleet\":");
+    fleet.writeJson(json);
+    json.append(",\"log\":");
+    logger.writeJson(json);
+    json.append("}");
+    server.send(200, "application/json", json.c_str());
+}
+
+// Mikrobenchmark gorących ścieżek na stałych danych. /bench?save=1 zapisuje
+// wynik jako bazę, /bench?threshold=N ustawia próg regresji [%].
+// Regresja względem bazy daje HTTP 409, więc wynik łatwo sprawdzić skryptem.
+// Alokacje i addEvent (który loguje) mierzy na hoście tools/hotpath_bench.
+void WebInterface::handleBench() {
+    heapMonitor.setPaused(true); // sztuczne wywołania nie trafiają do telemetrii sterty
+
+    benchmark.clear();
+    benchmarkMode = true;
+    benchmark.measure("sendPage", [](void* ctx) -> size_t {
+        WebInterface* web = static_cast<WebInterface*>(ctx);
+        web->benchmarkBytes = 0;
+        web->sendPage();
+        return web->benchmarkBytes;
+    }, this);
+    benchmark.measure("handleLog", [](void* ctx) -> size_t {
+        WebInterface* web = static_cast<WebInterface*>(ctx);
+        web->benchmarkBytes = 0;
+        web->handleLog();
+        return web->benchmarkBytes;
+    }, this);
+    benchmarkMode = false;
+
+    benchmark.measure("urlEncode", [](void*) -> size_t {
+        static const char message[] = "Pompa została automatycznie włączona - niski poziom wody";
+        char buffer[768]; // jak Notifier::postBuffer
+        TextBuffer out(buffer, sizeof(buffer));
+        out.appendUrlEncoded(message);
+        return out.length();
+    }, nullptr);
+    benchmark.measure("mqttCallback", [](void* ctx) -> size_t {
+        return static_cast<WaterMonitorMQTT*>(ctx)->benchmarkCallback();
+    }, &waterMQTT);
+    benchmark.measure("sendData", [](void* ctx) -> size_t {
+        return static_cast<WaterMonitorMQTT*>(ctx)->benchmarkPublish(false);
+    }, &waterMQTT);
+    benchmark.measure("sendDataCbor", [](void* ctx) -> size_t {
+        return static_cast<WaterMonitorMQTT*>(ctx)->benchmarkPublish(true);
+    }, &waterMQTT);
+    heapMonitor.setPaused(false);
+
+    if (server.hasArg("threshold")) benchmark.setThreshold(constrain(server.arg("threshold").toInt(), 1, 255));
+    if (server.hasArg("save")) benchmark.saveBaseline();
+
+    TextBuffer json(pageBuffer, sizeof(pageBuffer));
+    benchmark.writeJson(json);
+    server.send(benchmark.regressions() ? 409 : 200, "application/json", json.c_str());
+}
+
+// Zbiorczy panel floty (tylko na węźle-agregatorze)
+void WebInterface::handleFleet() {
+    sendPageHeader();
+    server.sendContent_P(PSTR("<div class='control-panel'><h3><i class='fas fa-network-wired'></i> Flota</h3>"));
+    if (!fleet.isAggregator()) {
+        server.sendContent_P(PSTR("<p>Ten węzeł nie jest agregatorem floty (zob. Konfiguracja).</p></div>"));
+        sendPageFooter();
+        return;
+    }
+    server.sendContent_P(PSTR("<table style='width:100%; border-collapse:collapse;'><tr><th align='left'>Węzeł</th><th>Poziom</th><th>Pompa</th><th>Tryb</th><th>Ostatnio</th></tr>"));
+    for (int i = 0; i < fleet.nodeCount(); i++) {
+        const FleetNode& n = fleet.node(i);
+        bool online = fleet.isOnline(n);
+        TextBuffer row(pageBuffer, sizeof(pageBuffer));
+        row.appendf("<tr style='%s'><td><div class='status-dot %s' style='display:inline-block;'></div>"
+                    "<a href='http://%s.local/'>%s</a></td><td align='center'>%u%%</td><td align='center'>%s</td>"
+                    "<td align='center'>%s</td><td align='center'>%lus</td></tr>",
+                    online ? "" : "opacity:0.5;", statusDot(online), n.name, n.name, n.waterLevel,
+                    (n.flags & FLEET_PUMP_ON) ? "ON" : "OFF",
+                    (n.flags & FLEET_TEST) ? "test" : ((n.flags & FLEET_MANUAL) ? "ręczny" : "auto"),
+                    (millis() - n.lastSeen) / 1000);
+        sendChunk(row);
+    }
+    server.sendContent_P(PSTR("</table></div>"));
+    sendPageFooter();
+}
+
+void WebInterface::handleFleetApi() {
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "application/json", "");
+    TextBuffer json(pageBuffer, sizeof(pageBuffer));
+    json.append("{\"fleet\":");
+    fleet.writeJson(json);
+    json.append(",\"nodes\":[");
+    for (int i = 0; i < fleet.nodeCount(); i++) {
+        if (i) json.append(',');
+        fleet.writeNodeJson(fleet.node(i), json);
+        if (json.length() > sizeof(pageBuffer) / 2) sendChunk(json);
+    }
+    json.append("]}");
+    sendChunk(json);
+    server.sendContent("");
 }
 
 void WebInterface::handleManual() {
     if (server.method() == HTTP_POST) {
         bool actionTaken = false;
+        // Zmiany stanu wykonuje zadanie sterujące; zdarzenia dopisuje PumpController
         if (server.hasArg("toggle")) {
-            pumpController.togglePumpManual();
-            systemState.addEvent(String("Ręczne sterowanie POMPA (WWW) – ") + (systemState.pumpOn ? "WŁĄCZONA" : "WYŁĄCZONA"));
-            // Powiadomienie Pushover jest wysyłane z poziomu PumpController
+            pumpController.sendCommand(PUMP_CMD_TOGGLE, PUMP_SRC_WEB);
             actionTaken = true;
         } else if (server.hasArg("test")) {
-            systemState.testMode = !systemState.testMode;
-            if (systemState.testMode) {
-                systemState.manualMode = true;
-                systemState.manualModeStartTime = millis();
-            } else {
-                systemState.manualMode = false;
-            }
-            systemState.addEvent(systemState.testMode ? "Włączono tryb testowy" : "Wyłączono tryb testowy");
+            pumpController.sendCommand(PUMP_CMD_TEST, PUMP_SRC_WEB);
             actionTaken = true;
         } else if (server.hasArg("auto")) {
-            systemState.manualMode = false;
-            systemState.testMode = false; // Wyjście z trybu manualnego wyłącza też testowy
-            systemState.addEvent("Przywrócono sterowanie automatyczne");
+            pumpController.sendCommand(PUMP_CMD_AUTO, PUMP_SRC_WEB);
             actionTaken = true;
         }
         
@@ -108,25 +301,27 @@ void WebInterface::handleManual() {
     }
 
     // Generowanie HTML dla przycisków sterowania ręcznego
+    ControlState state;
+    systemState.control.read(state);
     String content = R"rawliteral(
     <div class="control-panel">
         <style> .btn { padding: 10px 15px; border: none; border-radius: 5px; color: white; cursor: pointer; text-decoration: none; display: inline-block; font-size: 16px; margin-top: 10px; width: 100%; text-align: center; } .btn-pump { background-color: var(--primary); } .btn-pump:hover { background-color: #2980b9; } .btn-danger { background-color: var(--danger); } .btn-danger:hover { background-color: #c0392b; } .btn-primary { background-color: var(--secondary); } .btn-primary:hover { background-color: #27ae60; } .btn-secondary { background-color: #7f8c8d; } .btn-secondary:hover { background-color: #6c7a7d; } .control-group { margin-bottom: 20px; } </style>
         <div class="control-group">
             <h3><i class="fas fa-cog"></i> Sterowanie Pompą</h3>
             <form method="POST" action="/manual" style="margin: 0;"><button type="submit" name="toggle" value="1" class="btn btn-pump"><i class="fas fa-power-off"></i> )rawliteral";
-    content += systemState.pumpOn ? "WYŁĄCZ POMPĘ" : "WŁĄCZ POMPĘ";
+    content += state.pumpOn ? "WYŁĄCZ POMPĘ" : "WŁĄCZ POMPĘ";
     content += R"rawliteral(</button></form>
         </div>
         <div class="control-group">
             <h3><i class="fas fa-vial"></i> Tryb Testowy</h3>
             <form method="POST" action="/manual" style="margin: 0;"><button type="submit" name="test" value="1" class="btn )rawliteral";
-    content += systemState.testMode ? "btn-danger" : "btn-primary";
+    content += state.testMode ? "btn-danger" : "btn-primary";
     content += R"rawliteral("><i class="fas fa-flask"></i> )rawliteral";
-    content += systemState.testMode ? "Wyłącz Tryb Testowy" : "Włącz Tryb Testowy";
+    content += state.testMode ? "Wyłącz Tryb Testowy" : "Włącz Tryb Testowy";
     content += R"rawliteral(</button></form>
         </div>)rawliteral";
 
-    if (systemState.manualMode || systemState.testMode) {
+    if (state.manualMode || state.testMode) {
         content += R"rawliteral(
         <div class='control-group'>
             <h3><i class='fas fa-robot'></i> Sterowanie Automatyczne</h3>
@@ -135,11 +330,14 @@ void WebInterface::handleManual() {
     }
     content += "</div>";
     
-    sendPage(content);
+    sendPage(content.c_str());
 }
 
 
 void WebInterface::handleConfigForm() {
+    char hours[64];
+    TextBuffer peakText(hours, sizeof(hours));
+    PumpPolicy::formatHours(peakHours, peakText);
     String content = R"rawliteral(
     <div class="control-panel">
         <style> input { width: calc(100% - 10px); padding: 5px; } .btn-primary { padding: 10px 15px; border: none; border-radius: 5px; color: white; cursor: pointer; background-color: var(--primary); width: 100%; margin-top: 10px; } </style>
@@ -154,10 +352,14 @@ void WebInterface::handleConfigForm() {
             <label>Hasło Wi-Fi:</label><br><input type='password' name='pass' value=')rawliteral" + pass + R"rawliteral('><br><br>
             <label>Token Pushover:</label><br><input name='token' value=')rawliteral" + pushoverToken + R"rawliteral('><br><br>
             <label>Użytkownik Pushover:</label><br><input name='user' value=')rawliteral" + pushoverUser + R"rawliteral('><br><br>
+            <label>Nazwa węzła / mDNS (puste = z adresu MAC):</label><br><input name='node' value=')rawliteral" + nodeName + R"rawliteral('><br><br>
+            <label><input type='checkbox' name='aggregator' value='1' style='width:auto;')rawliteral" + (fleetAggregator ? " checked" : "") + R"rawliteral('> Agregator floty</label><br><br>
+            <label><input type='checkbox' name='adaptive' value='1' style='width:auto;')rawliteral" + (adaptivePump ? " checked" : "") + R"rawliteral('> Sterowanie adaptacyjne pompy (omijanie szczytu taryfy)</label><br><br>
+            <label>Godziny szczytu taryfy (np. 6-13,15-22; puste = brak):</label><br><input name='peak' value=')rawliteral" + peakText.c_str() + R"rawliteral('><br><br>
             <input type='submit' class='btn btn-primary' value='Zapisz i zrestartuj'>
         </form>
     </div>)rawliteral";
-    sendPage(content);
+    sendPage(content.c_str());
 }
 
 void WebInterface::handleSave() {
@@ -171,11 +373,14 @@ void WebInterface::handleSave() {
     preferences.putString("pass", server.arg("pass"));
     preferences.putString("pushtoken", server.arg("token"));
     preferences.putString("pushuser", server.arg("user"));
+    preferences.putString("nodeName", server.arg("node"));
+    preferences.putBool("aggregator", server.hasArg("aggregator"));
+    preferences.putBool("adaptive", server.hasArg("adaptive"));
+    preferences.putUInt("peakHours", PumpPolicy::parseHours(server.arg("peak").c_str()));
     preferences.putBool("configured", true);
     preferences.end();
     
-    String content = "<h3>Zapisano konfigurację. Restart za 3 sekundy...</h3>";
-    sendPage(content);
+    sendPage("<h3>Zapisano konfigurację. Restart za 3 sekundy...</h3>");
     delay(3000);
     ESP.restart();
 }
@@ -190,10 +395,11 @@ void WebInterface::handleMQTTConfig() {
         <label>Port:</label><br><input name='port' type='number' value=')rawliteral" + String(waterMQTT.getPort()) + R"rawliteral('><br><br>
         <label>Użytkownik:</label><br><input name='user' value=')rawliteral" + waterMQTT.getUser() + R"rawliteral('><br><br>
         <label>Hasło:</label><br><input name='pass' type='password' value=')rawliteral" + waterMQTT.getPassword() + R"rawliteral('><br><br>
+        <label><input type='checkbox' name='cbor' value='1' style='width:auto;')rawliteral" + (waterMQTT.isCompactFormat() ? " checked" : "") + R"rawliteral('> Format kompaktowy (CBOR, jeden temat wm/&lt;węzeł&gt;)</label><br><br>
         <input type='submit' class='btn btn-primary' value='Zapisz'>
       </form>
     </div>)rawliteral";
-    sendPage(content);
+    sendPage(content.c_str());
 }
 
 void WebInterface::handleSaveMQTT() {
@@ -201,19 +407,75 @@ void WebInterface::handleSaveMQTT() {
         server.arg("server"),
         server.arg("port").toInt(),
         server.arg("user"),
-        server.arg("pass")
+        server.arg("pass"),
+        server.hasArg("cbor")
     );
     waterMQTT.saveConfig(preferences);
     
-    String content = "<h3>Zapisano konfigurację MQTT. Zmiany zostaną zastosowane przy następnym połączeniu.</h3>";
-    sendPage(content);
+    sendPage("<h3>Zapisano konfigurację MQTT. Zmiany zostaną zastosowane przy następnym połączeniu.</h3>");
+}
+
+static const LogLevel LOG_LEVEL_CHOICES[] = {LOG_OFF, LOG_ERROR, LOG_WARN, LOG_INFO, LOG_DEBUG};
+static const char* const LOG_LEVEL_NAMES[] = {"wyłączone", "błędy", "ostrzeżenia", "informacje", "debug"};
+
+static void appendLevelSelect(TextBuffer& out, const char* name, const char* label, LogLevel current) {
+    out.appendf("<label>%s:</label><br><select name='%s'>", label, name);
+    for (size_t i = 0; i < sizeof(LOG_LEVEL_CHOICES) / sizeof(LOG_LEVEL_CHOICES[0]); i++) {
+        out.appendf("<option value='%u'%s>%s</option>", LOG_LEVEL_CHOICES[i],
+                    LOG_LEVEL_CHOICES[i] == current ? " selected" : "", LOG_LEVEL_NAMES[i]);
+    }
+    out.append("</select><br><br>");
+}
+
+// Konfiguracja ujść loggera - stosowana od razu, bez restartu
+void WebInterface::handleLogConfig() {
+    uint32_t syslogIp = logger.getSyslogServer();
+    sendPageHeader();
+    TextBuffer form(pageBuffer, sizeof(pageBuffer));
+    form.append("<div class='control-panel'><style> input, select { width: calc(100% - 10px); padding: 5px; } .btn-primary { padding: 10px 15px; border: none; border-radius: 5px; color: white; cursor: pointer; background-color: var(--primary); width: 100%; margin-top: 10px; } </style>"
+                "<h3><i class='fas fa-terminal'></i> Logi</h3><form action='/save_log' method='GET'>");
+    form.appendf("<label>Serwer syslog (IP, puste = wyłączony):</label><br><input name='server' value='%s'><br><br>",
+                 syslogIp ? logger.getSyslogServer().toString().c_str() : "");
+    form.appendf("<label>Port syslog (UDP):</label><br><input name='port' type='number' value='%u'><br><br>", logger.getSyslogPort());
+    sendChunk(form);
+    appendLevelSelect(form, "serial", "Serial", logger.getSinkLevel(LOG_SINK_SERIAL));
+    appendLevelSelect(form, "syslog", "Syslog", logger.getSinkLevel(LOG_SINK_SYSLOG));
+    appendLevelSelect(form, "mqtt", "MQTT (temat wm/&lt;węzeł&gt;/log)", logger.getSinkLevel(LOG_SINK_MQTT));
+    form.append("<input type='submit' class='btn btn-primary' value='Zapisz'></form></div>");
+    sendChunk(form);
+    sendPageFooter();
+}
+
+static LogLevel parseLogLevel(const String& value) {
+    long level = value.toInt();
+    for (LogLevel choice : LOG_LEVEL_CHOICES) {
+        if (choice == level) return choice;
+    }
+    return LOG_OFF;
+}
+
+void WebInterface::handleSaveLog() {
+    IPAddress syslogIp((uint32_t)0);
+    if (!server.arg("server").isEmpty() && !syslogIp.fromString(server.arg("server"))) {
+        sendPage("<h3>Niepoprawny adres IP serwera syslog.</h3>");
+        return;
+    }
+    long port = server.arg("port").toInt();
+    logger.setSyslogServer(syslogIp, port > 0 && port < 65536 ? port : 514);
+    logger.setSinkLevel(LOG_SINK_SERIAL, parseLogLevel(server.arg("serial")));
+    logger.setSinkLevel(LOG_SINK_SYSLOG, parseLogLevel(server.arg("syslog")));
+    logger.setSinkLevel(LOG_SINK_MQTT, parseLogLevel(server.arg("mqtt")));
+    logger.saveConfig(preferences);
+    logger.info(LOG_WEB, "Zmieniono konfigurację logów");
+
+    sendPage("<h3>Zapisano konfigurację logów. Zmiany obowiązują od razu.</h3>");
 }
 
 // --- Obsługa OTA ---
 void WebInterface::handleUpdateUpload() {
     HTTPUpload& upload = server.upload();
     if (upload.status == UPLOAD_FILE_START) {
-        Serial.printf("Rozpoczęcie aktualizacji: %s\n", upload.filename.c_str());
+        logger.info(LOG_WEB, "Rozpoczęcie aktualizacji: %s", upload.filename.c_str());
         if (!Update.begin(UPDATE_SIZE_UNKNOWN)) {
             Update.printError(Serial);
         }
@@ -223,7 +485,7 @@ void WebInterface::handleUpdateUpload() {
         }
     } else if (upload.status == UPLOAD_FILE_END) {
         if (Update.end(true)) {
-            Serial.printf("Aktualizacja zakończona: %u bajtów\n", upload.totalSize);
+            logger.info(LOG_WEB, "Aktualizacja zakończona: %u bajtów", (unsigned)upload.totalSize);
         } else {
             Update.printError(Serial);
         }
@@ -231,113 +493,122 @@ void WebInterface::handleUpdateUpload() {
 }
 
 // --- Główna funkcja do generowania i wysyłania strony ---
-void WebInterface::sendPage(const String& content) {
+// Fragmenty dynamiczne formatowane są w stałym buforze pageBuffer,
+// więc renderowanie strony nie alokuje na stercie.
+void WebInterface::sendPage(const char* content) {
+    sendPageHeader();
+    emit(content, strlen(content)); // Wstawienie dynamicznej zawartości (formularze)
+    sendPageFooter();
+}
+
+void WebInterface::sendChunk(TextBuffer& chunk) {
+    emit(chunk.c_str(), chunk.length());
+    chunk.clear();
+}
+
+void WebInterface::beginPage() {
+    if (benchmarkMode) return;
+    // API WebServer przyjmuje String - stałe nagłówki tworzone raz, nie przy każdej stronie
+    static const String cacheControl("Cache-Control"), noCache("no-cache");
     server.setContentLength(CONTENT_LENGTH_UNKNOWN);
-    server.sendHeader("Content-Type", "text/html; charset=utf-8");
-    server.sendHeader("Cache-Control", "no-cache");
-    server.send(200);
+    server.sendHeader(cacheControl, noCache);
+    server.send(200, "text/html; charset=utf-8");
+}
+
+void WebInterface::emit(const char* data, size_t length) {
+    if (benchmarkMode) benchmarkBytes += length;
+    else server.sendContent(data, length);
+}
+
+void WebInterface::emit_P(PGM_P data) {
+    if (benchmarkMode) benchmarkBytes += strlen_P(data);
+    else server.sendContent_P(data);
+}
+
+void WebInterface::endPage() {
+    if (!benchmarkMode) server.client().stop();
+}
 
-    String chunk;
+// Wejścia strony czytane raz na jej początku. Podczas pomiaru (/bench) są stałe,
+// więc rozmiar strony nie zależy od bieżącego stanu czujników, WiFi ani MQTT.
+void WebInterface::readPageInputs() {
+    if (benchmarkMode) {
+        pageState = ControlState();
+        pageState.pumpOn = true;
+        pageState.sensorLowState = true;
+        pageState.waterLevel = 30;
+        pageState.midSensorPresent = true;
+        pageWifi = pageMqtt = pagePushover = true;
+        return;
+    }
+    systemState.control.read(pageState); // Jedna spójna migawka dla całej strony
+    pageWifi = systemState.wifiConnected;
+    pageMqtt = waterMQTT.isConnected();
+    pagePushover = pushoverToken != "" && pushoverUser != "";
+}
+
+void WebInterface::sendPageHeader() {
+    HeapScope scope(HEAP_WEB);
+    readPageInputs();
+    beginPage();
 
     // Nagłówek i style
-    chunk = F(R"rawliteral(
-    <!DOCTYPE html>
-    <html lang="pl">
-    <head>
-      <meta charset="UTF-8"><meta name="viewport" content="width=device-width, initial-scale=1.0">
-      <title>System Zbiornika Wody</title>
-      <link href="https://fonts.googleapis.com/css2?family=Roboto:wght@300;400;500;700&display=swap" rel="stylesheet">
-      <link href="https://cdnjs.cloudflare.com/ajax/libs/font-awesome/5.15.4/css/all.min.css" rel="stylesheet">
-      <style>
-        :root { --primary: #3498db; --secondary: #2ecc71; --danger: #e74c3c; --warning: #f39c12; --dark: #2c3e50; --light: #ecf0f1; }
-        body { font-family: 'Roboto', sans-serif; background-color: #f5f7fa; color: #333; margin: 0; padding: 20px; }
-        .container { max-width: 1000px; margin: 0 auto; background: white; border-radius: 15px; box-shadow: 0 5px 15px rgba(0,0,0,0.1); overflow: hidden; }
-        header { background: linear-gradient(135deg, var(--primary), var(--dark)); color: white; padding: 20px; text-align: center; }
-        .badge { display: inline-block; padding: 5px 10px; border-radius: 20px; font-size: 14px; margin-top: 10px; font-weight: 500; }
-        .test-mode { background-color: var(--warning); color: white; }
-        .manual-mode { background-color: var(--primary); color: white; }
-        .dashboard { display: grid; grid-template-columns: 2fr 1fr; gap: 20px; padding: 20px; }
-        @media (max-width: 768px) { .dashboard { grid-template-columns: 1fr; } }
-        .tank-container { background: white; border-radius: 10px; padding: 20px; box-shadow: 0 3px 10px rgba(0,0,0,0.05); }
-        .tank { position: relative; max-width: 300px; margin: 0 auto; width: 100%; height: 300px; background: #e0f2fe; border-radius: 5px; overflow: hidden; border: 3px solid #b3e0ff; }
-        .water { position: absolute; bottom: 0; width: 100%; background: linear-gradient(to top, #3b82f6, #60a5fa); transition: height 0.5s ease; }
-        .sensor { position: absolute; left: 10px; width: calc(100% - 20px); height: 3px; background: var(--dark); border-radius: 3px; }
-        .sensor::after { content: ''; position: absolute; right: -15px; top: -5px; width: 10px; height: 10px; border-radius: 50%; }
-        .sensor.high { top: 10%; }
-        .sensor.mid { top: 35%; }
-        .sensor.low { top: 70%; }
-        .sensor-label { position: absolute; right: -80px; top: -10px; font-size: 14px; font-weight: 500; white-space: nowrap; }
-        .water-percentage { position: absolute; top: 50%; left: 50%; transform: translate(-50%, -50%); font-size: 24px; font-weight: 700; color: rgba(255,255,255,0.8); text-shadow: 0 2px 4px rgba(0,0,0,0.3); }
-        .status-indicator { display: flex; align-items: center; margin-bottom: 10px; }
-        .status-dot { width: 12px; height: 12px; border-radius: 50%; margin-right: 10px; }
-        .status-on { background-color: var(--secondary); }
-        .status-off { background-color: var(--danger); }
-        .nav { display: flex; justify-content: space-around; background: var(--light); padding: 15px; border-radius: 10px; margin-top: 20px; }
-        .nav a { color: var(--dark); text-decoration: none; font-weight: 500; transition: color 0.3s; }
-        .nav a:hover { color: var(--primary); }
-        .control-panel { background: white; border-radius: 10px; padding: 20px; box-shadow: 0 3px 10px rgba(0,0,0,0.05); }
-      </style>
-    </head>
-    <body><div class="container"><header><h1><i class="fas fa-tint"></i> System Zbiornika Wody</h1>
-    )rawliteral");
-    server.sendContent(chunk);
-    
+    emit_P(PAGE_HEAD);
+
+    TextBuffer chunk(pageBuffer, sizeof(pageBuffer));
+
     // Status trybu pracy
-    chunk = "";
-    if (systemState.testMode) {
-        chunk = F("<div class='badge test-mode'><i class='fas fa-flask'></i> Tryb testowy</div>");
-    } else if (systemState.manualMode) {
-        unsigned long remaining = (systemState.manualModeStartTime + systemState.manualModeTimeout - millis()) / 60000;
-        chunk = "<div class='badge manual-mode'><i class='fas fa-hand-paper'></i> Tryb manualny (" + String(remaining) + " min)</div>";
+    if (pageState.testMode) {
+        chunk.append("<div class='badge test-mode'><i class='fas fa-flask'></i> Tryb testowy</div>");
+    } else if (pageState.manualMode) {
+        unsigned long remaining = (pageState.manualModeStartTime + systemState.manualModeTimeout - millis()) / 60000;
+        chunk.appendf("<div class='badge manual-mode'><i class='fas fa-hand-paper'></i> Tryb manualny (%lu min)</div>", remaining);
     }
-    server.sendContent(chunk);
 
     // Wizualizacja zbiornika
-    chunk = F("</header><div class='dashboard'><div class='tank-container'><h2><i class='fas fa-water'></i> Wizualizacja Zbiornika</h2><div class='tank'>");
-    server.sendContent(chunk);
-    
-    chunk = "<div class='water' style='height:" + String(systemState.waterLevel) + "%'><div class='water-percentage'>" + String(systemState.waterLevel) + "%</div></div>";
-    server.sendContent(chunk);
+    chunk.append("</header><div class='dashboard'><div class='tank-container'><h2><i class='fas fa-water'></i> Wizualizacja Zbiornika</h2><div class='tank'>");
+    chunk.appendf("<div class='water' style='height:%d%%'><div class='water-percentage'>%d%%</div></div>",
+                  pageState.waterLevel, pageState.waterLevel);
+    sendChunk(chunk);
 
     // Czujniki
-    bool low = systemState.testMode || systemState.sensorLowState;
-    bool high = systemState.testMode || systemState.sensorHighState;
-    bool mid = (sensorMidPin != -1) ? (systemState.testMode || systemState.sensorMidState) : false;
-    
-    chunk = "<div class='sensor high' style='background:" + String(high ? "var(--secondary)" : "var(--danger)") + ";'><span class='sensor-label'>Górny: " + (high ? "Zanurzony" : "Suchy") + "</span></div>";
-    if(sensorMidPin != -1) chunk += "<div class='sensor mid' style='background:" + String(mid ? "var(--secondary)" : "var(--danger)") + ";'><span class='sensor-label'>Środkowy: " + (mid ? "Zanurzony" : "Suchy") + "</span></div>";
-    chunk += "<div class='sensor low' style='background:" + String(low ? "var(--secondary)" : "var(--danger)") + ";'><span class='sensor-label'>Dolny: " + (low ? "Zanurzony" : "Suchy") + "</span></div>";
-    server.sendContent(chunk);
+    bool low = pageState.sensorLowState; // migawka zawiera już nadpisanie trybu testowego
+    bool high = pageState.sensorHighState;
+    bool mid = pageState.sensorMidState;
+
+    chunk.appendf("<div class='sensor high' style='background:%s;'><span class='sensor-label'>Górny: %s</span></div>",
+                  sensorColor(high), high ? "Zanurzony" : "Suchy");
+    if (pageState.midSensorPresent) {
+        chunk.appendf("<div class='sensor mid' style='background:%s;'><span class='sensor-label'>Środkowy: %s</span></div>",
+                      sensorColor(mid), mid ? "Zanurzony" : "Suchy");
+    }
+    chunk.appendf("<div class='sensor low' style='background:%s;'><span class='sensor-label'>Dolny: %s</span></div>",
+                  sensorColor(low), low ? "Zanurzony" : "Suchy");
 
     // Prawa kolumna (zawartość i status)
-    chunk = F("</div></div><div>");
-    server.sendContent(chunk);
-    
-    server.sendContent(content); // Wstawienie dynamicznej zawartości (logi/formularze)
-    
-    chunk = F("<div class='control-panel' style='margin-top:20px;'><h3><i class='fas fa-info-circle'></i> Status Systemu</h3>");
-    server.sendContent(chunk);
-
-    chunk = "<div class='status-indicator'><div class='status-dot " + String(systemState.pumpOn ? "status-on" : "status-off") + "'></div><span>Pompa: " + (systemState.pumpOn ? "WŁĄCZONA" : "WYŁĄCZONA") + "</span></div>";
-    chunk += "<div class='status-indicator'><div class='status-dot " + String(systemState.wifiConnected ? "status-on" : "status-off") + "'></div><span>WiFi: " + (systemState.wifiConnected ? "Podłączone" : "Rozłączone") + "</span></div>";
-    chunk += "<div class='status-indicator'><div class='status-dot " + String(waterMQTT.isConnected() ? "status-on" : "status-off") + "'></div><span>MQTT: " + (waterMQTT.isConnected() ? "Połączony" : "Rozłączony") + "</span></div>";
-    chunk += "<div class='status-indicator'><div class='status-dot " + String((pushoverToken != "" && pushoverUser != "") ? "status-on" : "status-off") + "'></div><span>Powiadomienia: " + ((pushoverToken != "" && pushoverUser != "") ? "Aktywne" : "Nieaktywne") + "</span></div>";
-    server.sendContent(chunk);
-    
+    chunk.append("</div></div><div>");
+    sendChunk(chunk);
+}
+
+void WebInterface::sendPageFooter() {
+    HeapScope scope(HEAP_WEB);
+    TextBuffer chunk(pageBuffer, sizeof(pageBuffer));
+
+    chunk.append("<div class='control-panel' style='margin-top:20px;'><h3><i class='fas fa-info-circle'></i> Status Systemu</h3>");
+    chunk.appendf("<div class='status-indicator'><div class='status-dot %s'></div><span>Pompa: %s</span></div>",
+                  statusDot(pageState.pumpOn), pageState.pumpOn ? "WŁĄCZONA" : "WYŁĄCZONA");
+    chunk.appendf("<div class='status-indicator'><div class='status-dot %s'></div><span>WiFi: %s</span></div>",
+                  statusDot(pageWifi), pageWifi ? "Podłączone" : "Rozłączone");
+    sendChunk(chunk);
+    chunk.appendf("<div class='status-indicator'><div class='status-dot %s'></div><span>MQTT: %s</span></div>",
+                  statusDot(pageMqtt), pageMqtt ? "Połączony" : "Rozłączony");
+    chunk.appendf("<div class='status-indicator'><div class='status-dot %s'></div><span>Powiadomienia: %s</span></div>",
+                  statusDot(pagePushover), pagePushover ? "Aktywne" : "Nieaktywne");
+    sendChunk(chunk);
+
     // Nawigacja i zamknięcie strony
-    chunk = F(R"rawliteral(
-        </div></div></div>
-        <div class="nav">
-            <a href="/"><i class="fas fa-home"></i> Strona Główna</a>
-            <a href="/manual"><i class="fas fa-hand-paper"></i> Sterowanie</a>
-            <a href="/config"><i class="fas fa-sliders-h"></i> Konfiguracja</a>
-            <a href="/mqtt_config"><i class="fas fa-cloud"></i> MQTT</a>
-            <a href="/log"><i class="fas fa-history"></i> Historia</a>
-        </div>
-    </div></body></html>
-    )rawliteral");
-    server.sendContent(chunk);
+    emit_P(PAGE_FOOT);
 
     // Finalizuj odpowiedź
-    server.client().stop();
+    endPage();
 }
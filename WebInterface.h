@@ -6,10 +6,15 @@
 #include "SystemState.h"
 #include "WaterMonitorMQTT.h"
 #include "PumpController.h"
+#include "HeapMonitor.h"
+#include "Scheduler.h"
+#include "Fleet.h"
+#include "TextBuffer.h"
+#include "Benchmark.h"
 
 class WebInterface {
 public:
-    WebInterface(SystemState& state, WaterMonitorMQTT& mqtt, PumpController& pump, Preferences& prefs);
+    WebInterface(SystemState& state, WaterMonitorMQTT& mqtt, PumpController& pump, Preferences& prefs, Scheduler& sched, Fleet& fleet);
     void begin();
     void handleClient();
 
@@ -21,20 +26,54 @@ private:
     void handleLog();
     void handleMQTTConfig();
     void handleSaveMQTT();
+    void handleLogConfig();
+    void handleSaveLog();
     void handleUpdate();
     void handleUpdateUpload();
+    void handleStats();
+    void handleFleet();
+    void handleFleetApi();
+    void handleBench();
+    void loadLocalConfig();
 
-    void sendPage(String content = "");
+    void sendPage(const char* content = "");
+    void readPageInputs();
+    void sendPageHeader();
+    void sendPageFooter();
+    void sendChunk(TextBuffer& chunk);
+    void beginPage();
+    void emit(const char* data, size_t length);
+    void emit_P(PGM_P data);
+    void endPage();
 
     WebServer server;
     SystemState& systemState;
     WaterMonitorMQTT& waterMQTT;
     PumpController& pumpController;
     Preferences& preferences;
+    Scheduler& scheduler;
+    Fleet& fleet;
+    Benchmark benchmark;
+
+    // Podczas pomiaru (/bench) strona nie trafia do klienta - liczone są tylko bajty
+    bool benchmarkMode = false;
+    size_t benchmarkBytes = 0;
     
     // Zmienne konfiguracyjne, które nie są częścią stanu 'live'
-    String ssid, pass, pushoverToken, pushoverUser;
+    String ssid, pass, pushoverToken, pushoverUser, nodeName;
+    bool fleetAggregator = false;
+    bool adaptivePump = false;
+    uint32_t peakHours = 0;
     int sensorLowPin, sensorHighPin, sensorMidPin, relayPin, manualButtonPin;
+
+    // Migawka stanu, z której renderowana jest bieżąca strona
+    ControlState pageState;
+    bool pageWifi = false;
+    bool pageMqtt = false;
+    bool pagePushover = false;
+
+    // Bufor roboczy do składania fragmentów strony i odpowiedzi JSON
+    char pageBuffer[2048];
 };
 
 #endif
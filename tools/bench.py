@@ -0,0 +1,50 @@
+#!/usr/bin/env python3
+"""Uruchamia mikrobenchmark /bench na urządzeniu i sprawdza regresje.
+
+Użycie: python3 bench.py --host water-monitor.local [--out wyniki.json] [--save] [--threshold 20]
+Kod wyjścia 1, gdy którykolwiek przypadek przekroczył próg względem bazy w NVS.
+"""
+import argparse
+import json
+import sys
+import urllib.error
+import urllib.parse
+import urllib.request
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--host", required=True)
+    parser.add_argument("--out", help="zapisz wynik JSON do pliku")
+    parser.add_argument("--save", action="store_true", help="zapisz wynik jako nową bazę")
+    parser.add_argument("--threshold", type=int, help="dopuszczalny wzrost [%%]")
+    args = parser.parse_args()
+
+    query = {}
+    if args.save:
+        query["save"] = "1"
+    if args.threshold:
+        query["threshold"] = str(args.threshold)
+    url = "http://%s/bench?%s" % (args.host, urllib.parse.urlencode(query))
+    try:
+        with urllib.request.urlopen(url, timeout=30) as response:
+            body = response.read()
+    except urllib.error.HTTPError as error:
+        if error.code != 409:
+            raise
+        body = error.read()  # 409 = regresja, treść zawiera wyniki
+
+    result = json.loads(body)
+    if args.out:
+        with open(args.out, "w") as f:
+            json.dump(result, f, indent=2)
+
+    print("%-14s %10s %8s %10s" % ("przypadek", "ns", "bajty", "baza ns"))
+    for r in result["results"]:
+        flag = "  REGRESJA" if r.get("regressed") else ""
+        print("%-14s %10d %8d %10s%s" % (r["name"], r["ns"], r["bytes"], r.get("baseNs", "-"), flag))
+    return 1 if result["regressions"] else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,188 @@
+// Agregator floty na hoście: prawdziwy Fleet w trybie agregatora na WiFiUDP
+// z gniazdami (tools/host), więc odbiera beacony z grupy multicast jak węzeł.
+//
+//   fleet_agg [--iface 127.0.0.1] [--out fleet.json] [--seconds N]
+//       zegar symulowany idzie za rzeczywistym; co sekundę zapisuje tabelę
+//       w formacie /api/fleet do --out (albo na stdout po zakończeniu).
+//       Nadawcy: tools/fleet_sim.py --table fleet.json --iface 127.0.0.1
+//   fleet_agg --check
+//       kontrola dla make check na pętli zwrotnej i zegarze symulowanym:
+//       FLEET_MAX_NODES+ węzłów, pełna tabela, odzysk miejsc po węzłach offline.
+//       Kod 1 przy błędzie.
+
+#include "Fleet.h"
+#include <chrono>
+#include <thread>
+
+static SystemState systemState;
+static Fleet fleet(systemState);
+static char tableBuffer[16384];
+
+static const uint32_t ID_BASE = 0x51A00000; // jak tools/fleet_sim.py
+
+// To samo co /api/fleet (WebInterface::handleFleetApi)
+static const char* tableJson() {
+    TextBuffer json(tableBuffer, sizeof(tableBuffer));
+    json.append("{\"fleet\":");
+    fleet.writeJson(json);
+    json.append(",\"nodes\":[");
+    for (int i = 0; i < fleet.nodeCount(); i++) {
+        if (i) json.append(',');
+        fleet.writeNodeJson(fleet.node(i), json);
+    }
+    json.append("]}\n");
+    return json.c_str();
+}
+
+// Zapis przez plik tymczasowy - czytelnik nie trafi na połowę tabeli
+static bool writeTable(const char* path) {
+    char temp[256];
+    snprintf(temp, sizeof(temp), "%s.tmp", path);
+    FILE* f = fopen(temp, "w");
+    if (!f) return false;
+    fputs(tableJson(), f);
+    fclose(f);
+    return rename(temp, path) == 0;
+}
+
+static int runRealtime(const char* out, int seconds) {
+    auto start = std::chrono::steady_clock::now();
+    auto last = start;
+    unsigned long lastDump = 0;
+    for (;;) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        auto now = std::chrono::steady_clock::now();
+        hostAdvance(std::chrono::duration_cast<std::chrono::milliseconds>(now - last).count());
+        last = now;
+        fleet.loop();
+        if (out && millis() - lastDump >= 1000) {
+            lastDump = millis();
+            if (!writeTable(out)) {
+                perror(out);
+                return 1;
+            }
+        }
+        if (seconds > 0 && now - start >= std::chrono::seconds(seconds)) break;
+    }
+    if (!out) fputs(tableJson(), stdout);
+    return 0;
+}
+
+// --- Kontrola (make check) ---
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+    printf("%-56s %s\n", what, ok ? "ok" : "BLAD");
+    if (!ok) failures++;
+}
+
+static WiFiUDP sender;
+
+static void sendBeacons(uint32_t firstId, int nodes) {
+    static const IPAddress group(239, 255, 43, 21);
+    for (int i = 0; i < nodes; i++) {
+        FleetNode node;
+        node.nodeId = firstId + i;
+        snprintf(node.name, sizeof(node.name), "sim-%02x", (unsigned)(node.nodeId & 0xff));
+        node.seq = 1;
+        node.waterLevel = 50;
+        uint8_t buf[FLEET_BEACON_SIZE];
+        size_t len = Fleet::encode(node, buf);
+        sender.beginPacket(group, 43210);
+        sender.write(buf, len);
+        sender.endPacket();
+    }
+}
+
+// Odbiór paczkami po 16 na loop(), jak na urządzeniu; czas biegnie po 10 ms
+static void settle() {
+    for (int i = 0; i < 100; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        hostAdvance(10);
+        fleet.loop();
+    }
+}
+
+static bool present(uint32_t id) {
+    for (int i = 0; i < fleet.nodeCount(); i++) {
+        if (fleet.node(i).nodeId == id) return fleet.isOnline(fleet.node(i));
+    }
+    return false;
+}
+
+static uint32_t counter(const char* key) {
+    char buf[256];
+    TextBuffer json(buf, sizeof(buf));
+    fleet.writeJson(json);
+    char pattern[32];
+    snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+    const char* at = strstr(json.c_str(), pattern);
+    return at ? strtoul(at + strlen(pattern), nullptr, 10) : UINT32_MAX;
+}
+
+static int runCheck() {
+    static const int EXTRA = 6;
+    static const int FIRST = FLEET_MAX_NODES + EXTRA; // więcej węzłów niż miejsc w tabeli
+    static const int SECOND = 10;
+
+    settle(); // własny beacon agregatora zajmuje pierwsze miejsce
+    sendBeacons(ID_BASE, FIRST);
+    settle();
+    int stored = 0;
+    for (int i = 0; i < FIRST; i++) stored += present(ID_BASE + i);
+    expect(counter("received") == (uint32_t)FIRST, "odebrane beacony wszystkich nadawcow");
+    expect(fleet.nodeCount() == FLEET_MAX_NODES && stored == FLEET_MAX_NODES - 1,
+           "pelna tabela: agregator + FLEET_MAX_NODES-1 wezlow");
+    expect(counter("tableFull") == (uint32_t)(FIRST - stored), "nadmiar liczony w tableFull");
+
+    // Nadawcy milkną; agregator żyje (własny heartbeat), reszta wypada z online
+    for (int i = 0; i < 100; i++) {
+        hostAdvance(1000);
+        fleet.loop();
+    }
+    sendBeacons(ID_BASE + 0x1000, SECOND);
+    settle();
+    int recycled = 0;
+    for (int i = 0; i < SECOND; i++) recycled += present(ID_BASE + 0x1000 + i);
+    expect(recycled == SECOND && fleet.nodeCount() == FLEET_MAX_NODES,
+           "nowe wezly zajmuja miejsca po wezlach offline");
+    expect(present(Fleet::localNodeId()), "agregator zostaje w tabeli");
+    expect(counter("tableFull") == (uint32_t)(FIRST - stored), "odzysk miejsc bez tableFull");
+    const char* table = tableJson();
+    int rows = 0;
+    for (const char* p = table; (p = strstr(p, "{\"id\":")); p++) rows++;
+    static const char head[] = "{\"fleet\":{\"node\":\"agregator-host\"";
+    expect(strncmp(table, head, sizeof(head) - 1) == 0 && rows == FLEET_MAX_NODES,
+           "tabela w formacie /api/fleet");
+    return failures ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    const char* out = nullptr;
+    const char* iface = "127.0.0.1";
+    int seconds = 0;
+    bool check = false;
+    bool usage = false;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--check")) check = true;
+        else if (!strcmp(argv[i], "--out") && i + 1 < argc) out = argv[++i];
+        else if (!strcmp(argv[i], "--iface") && i + 1 < argc) iface = argv[++i];
+        else if (!strcmp(argv[i], "--seconds") && i + 1 < argc) seconds = atoi(argv[++i]);
+        else usage = true;
+    }
+    // Bez --out i --seconds tabela nigdy nie zostałaby wypisana
+    if (usage || (!check && !out && seconds <= 0)) {
+        fprintf(stderr, "uzycie: %s --check | [--iface ip] [--out plik.json] [--seconds N]\n", argv[0]);
+        return 2;
+    }
+
+    if (!WiFiUDP::hostMulticastIf.fromString(iface)) {
+        fprintf(stderr, "zly adres interfejsu: %s\n", iface);
+        return 2;
+    }
+    hostSetMillis(1000);
+    systemState.wifiConnected = true;
+    fleet.begin("agregator-host", true);
+    return check ? runCheck() : runRealtime(out, seconds);
+}
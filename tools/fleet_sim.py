@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+"""Symulacja floty: N procesów nadaje beacony jak węzły (każdy z własnym
+identyfikatorem), a potem sprawdza tabelę agregatora w /api/fleet.
+
+Użycie: python3 fleet_sim.py --aggregator zbiornik-abc123.local [--nodes 10] [--interval 5]
+                            [--wait 20] [--iface 192.168.1.10]
+Bez urządzenia: agregator na komputerze (tools/build/fleet_agg) zapisuje tabelę
+w tym samym formacie do pliku, który czyta --table:
+        tools/build/fleet_agg --out /tmp/fleet.json &
+        python3 fleet_sim.py --table /tmp/fleet.json --iface 127.0.0.1
+Bez --aggregator i --table tylko nadaje przez --wait sekund.
+Kod wyjścia 1, gdy któregoś węzła brakuje w tabeli albo jest offline.
+"""
+import argparse
+import json
+import multiprocessing
+import random
+import socket
+import struct
+import sys
+import time
+import urllib.request
+
+GROUP, PORT = "239.255.43.21", 43210
+VERSION = 1
+PUMP_ON, CHANGE = 0x01, 0x10
+IN_LOW, IN_MID, IN_HIGH = 0x01, 0x02, 0x04
+MIN_CHANGE_INTERVAL = 1.0
+ID_BASE = 0x51A00000  # identyfikator węzła = ID_BASE + numer procesu
+
+
+def encode(node_id, seq, uptime, flags, level, inputs, name):
+    """Beacon 36 B, little-endian - układ jak Fleet::encode()."""
+    return struct.pack("<2sBBIIIBB2x16s", b"WM", VERSION, flags, node_id, seq, uptime,
+                       level, inputs, name.encode("ascii")[:16])
+
+
+def sensors(level):
+    return (IN_LOW if level >= 20 else 0) | (IN_MID if level >= 50 else 0) | (IN_HIGH if level >= 90 else 0)
+
+
+def run_node(index, interval, iface, stop):
+    """Jeden węzeł: poziom wody spada z poborem, pompa dopełnia w histerezie 20-90%."""
+    node_id = ID_BASE + index
+    name = "sim-%02d" % index
+    rng = random.Random(node_id)
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM, socket.IPPROTO_UDP)
+    sock.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_TTL, 1)
+    if iface:
+        sock.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_IF, socket.inet_aton(iface))
+
+    start = time.monotonic()
+    level = rng.randint(25, 85)
+    pump = False
+    seq = 0
+    last_state = None
+    last_beacon = last_change = -interval
+    while not stop.is_set():
+        now = time.monotonic()
+        level = max(0, min(100, level + (3 if pump else 0) - rng.choice((0, 1, 1, 2))))
+        if level < 20:
+            pump = True
+        elif level >= 90:
+            pump = False
+        state = (pump, sensors(level))
+        changed = state != last_state and now - last_change >= MIN_CHANGE_INTERVAL
+        if changed or now - last_beacon >= interval:
+            seq += 1
+            flags = (PUMP_ON if pump else 0) | (CHANGE if changed else 0)
+            sock.sendto(encode(node_id, seq, int(now - start), flags, level, state[1], name), (GROUP, PORT))
+            last_beacon = now
+            if changed:
+                last_change = now
+                last_state = state
+        stop.wait(0.5)
+
+
+def load_table(aggregator, table_file):
+    if table_file:
+        with open(table_file) as f:
+            return json.load(f)
+    with urllib.request.urlopen("http://%s/api/fleet" % aggregator, timeout=10) as response:
+        return json.load(response)
+
+
+def check(table, count):
+    by_id = {int(n["id"], 16): n for n in table["nodes"]}
+    missing = 0
+    print("%-8s %-8s %-6s %6s %6s %5s" % ("id", "nazwa", "online", "seq", "poziom", "pompa"))
+    for index in range(count):
+        node = by_id.get(ID_BASE + index)
+        if node is None:
+            print("%08x %-8s BRAK" % (ID_BASE + index, "sim-%02d" % index))
+            missing += 1
+            continue
+        if not node["online"]:
+            missing += 1
+        print("%s %-8s %-6s %6d %6d %5s" % (node["id"], node["name"], node["online"], node["seq"],
+                                            node["level"], node["pump"]))
+    fleet = table["fleet"]
+    print("agregator %s: węzłów %d, odebrane %d, odrzucone %d, pełna tabela %d" % (
+        fleet["node"], fleet["nodes"], fleet["received"], fleet["rejected"], fleet["tableFull"]))
+    return missing
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--aggregator", help="adres węzła-agregatora (np. zbiornik-abc123.local)")
+    parser.add_argument("--table", help="plik z tabelą zapisywaną przez tools/build/fleet_agg --out")
+    parser.add_argument("--nodes", type=int, default=10, help="liczba symulowanych węzłów")
+    parser.add_argument("--interval", type=float, default=5, help="okres heartbeatu [s]")
+    parser.add_argument("--wait", type=float, default=20, help="czas nadawania przed odczytem tabeli [s]")
+    parser.add_argument("--iface", help="adres IPv4 interfejsu do wysyłki multicastu")
+    args = parser.parse_args()
+
+    stop = multiprocessing.Event()
+    nodes = [multiprocessing.Process(target=run_node, args=(i, args.interval, args.iface, stop), daemon=True)
+             for i in range(args.nodes)]
+    for node in nodes:
+        node.start()
+    try:
+        time.sleep(args.wait)
+        checked = args.aggregator or args.table
+        missing = check(load_table(args.aggregator, args.table), args.nodes) if checked else 0
+    finally:
+        stop.set()
+        for node in nodes:
+            node.join()
+    if missing:
+        print("brak albo offline: %d z %d węzłów" % (missing, args.nodes))
+    return 1 if missing else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
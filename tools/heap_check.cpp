@@ -0,0 +1,39 @@
+// Kontrola alokacji gorących ścieżek: każdą ścieżkę z hot_paths.cpp wywołuje
+// na stałym stanie i liczy malloc/new na wywołanie (po jednym rozgrzewającym).
+// Kończy się kodem 1, jeśli którakolwiek ścieżka alokuje więcej niż wymusza
+// API biblioteki (HotPath::allowedAllocs, zwykle 0).
+//
+//   make -C tools check
+//
+// Na urządzeniu /stats podaje tylko bilans wolnej sterty per podsystem
+// (HeapScope); liczba alokacji jest sprawdzana tutaj.
+
+#include "hot_paths.h"
+#include "alloc_count.h"
+
+static const int CALLS = 20;
+
+int main() {
+    hotPathsBegin();
+
+    int failures = 0;
+    printf("%-14s %-9s %12s %12s %10s\n", "sciezka", "podsystem", "alokacje", "bajty", "wyjscie");
+    for (int i = 0; i < HOT_PATH_COUNT; i++) {
+        const HotPath& path = HOT_PATHS[i];
+        path.prepare();
+        path.run();
+
+        AllocCounters before = hostAllocCounters();
+        HotPathSeries series = hotPathSeries(path, CALLS);
+        AllocCounters after = hostAllocCounters();
+        size_t output = series.bytes;
+
+        double calls = (double)series.allocs / CALLS;
+        double bytes = (double)(after.bytes - before.bytes) / CALLS;
+        bool allocates = series.allocs > (uint64_t)path.allowedAllocs * CALLS;
+        if (allocates) failures++;
+        printf("%-14s %-9s %12.1f %12.1f %10zu  %s\n", path.name, HeapMonitor::subsystemName(path.subsystem),
+               calls, bytes, output / CALLS, allocates ? "ALOKUJE" : "ok");
+    }
+    return failures ? 1 : 0;
+}
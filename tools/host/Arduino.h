@@ -0,0 +1,163 @@
+// Zastępcza warstwa Arduino do budowania modułów firmware na Linuksie
+// (symulacje i pomiary w tools/). Czas jest symulowany: millis()/micros()
+// stoją w miejscu, dopóki narzędzie nie przesunie zegara hostAdvance().
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <functional>
+
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 1
+#define OUTPUT 2
+#define INPUT_PULLUP 5
+#define CHANGE 3
+#define IRAM_ATTR
+#define PROGMEM
+#define PSTR(x) (x)
+#define F(x) (x)
+typedef const char* PGM_P;
+#define strlen_P strlen
+#define digitalPinToInterrupt(p) (p)
+#define constrain(x, lo, hi) ((x) < (lo) ? (lo) : ((x) > (hi) ? (hi) : (x)))
+
+class __FlashStringHelper;
+
+// Napis na stercie jak w rdzeniu Arduino - każda zmiana długości to malloc/realloc,
+// więc narzędzia liczące alokacje widzą je tak samo jak na urządzeniu
+class String {
+public:
+    String(const char* s = "") { assign(s ? s : "", s ? strlen(s) : 0); }
+    String(const String& other) { assign(other.c_str(), other.len); }
+    String(String&& other) noexcept : buf(other.buf), len(other.len) { other.buf = nullptr; other.len = 0; }
+    explicit String(char c) { assign(&c, 1); }
+    String(int value) { char tmp[24]; assignNumber(tmp, snprintf(tmp, sizeof(tmp), "%d", value)); }
+    String(unsigned int value) { char tmp[24]; assignNumber(tmp, snprintf(tmp, sizeof(tmp), "%u", value)); }
+    String(long value) { char tmp[24]; assignNumber(tmp, snprintf(tmp, sizeof(tmp), "%ld", value)); }
+    String(unsigned long value) { char tmp[24]; assignNumber(tmp, snprintf(tmp, sizeof(tmp), "%lu", value)); }
+    ~String() { free(buf); }
+
+    String& operator=(const String& other) { if (this != &other) assign(other.c_str(), other.len); return *this; }
+    String& operator=(String&& other) noexcept {
+        if (this != &other) { free(buf); buf = other.buf; len = other.len; other.buf = nullptr; other.len = 0; }
+        return *this;
+    }
+    String& operator=(const char* s) { assign(s ? s : "", s ? strlen(s) : 0); return *this; }
+
+    const char* c_str() const { return buf ? buf : ""; }
+    unsigned int length() const { return len; }
+    bool isEmpty() const { return len == 0; }
+    int toInt() const { return atoi(c_str()); }
+    char charAt(unsigned int i) const { return i < len ? buf[i] : 0; }
+
+    String& operator+=(const String& other) { append(other.c_str(), other.len); return *this; }
+    String& operator+=(const char* s) { if (s) append(s, strlen(s)); return *this; }
+    String& operator+=(char c) { append(&c, 1); return *this; }
+
+    bool operator==(const String& other) const { return strcmp(c_str(), other.c_str()) == 0; }
+    bool operator!=(const String& other) const { return !(*this == other); }
+    bool operator==(const char* s) const { return strcmp(c_str(), s ? s : "") == 0; }
+    bool operator!=(const char* s) const { return !(*this == s); }
+
+    friend String operator+(const String& a, const String& b) { String r(a); r += b; return r; }
+    friend String operator+(const String& a, const char* b) { String r(a); r += b; return r; }
+    friend String operator+(const char* a, const String& b) { String r(a); r += b; return r; }
+
+private:
+    void assign(const char* s, size_t n) {
+        if (n == 0) { // pusty napis bez bufora, jak w rdzeniu
+            free(buf);
+            buf = nullptr;
+            len = 0;
+            return;
+        }
+        char* copy = (char*)malloc(n + 1);
+        memcpy(copy, s, n);
+        copy[n] = '\0';
+        free(buf);
+        buf = copy;
+        len = n;
+    }
+    void append(const char* s, size_t n) {
+        if (n == 0) return;
+        buf = (char*)realloc(buf, len + n + 1);
+        memcpy(buf + len, s, n);
+        len += n;
+        buf[len] = '\0';
+    }
+    void assignNumber(const char* digits, int n) { assign(digits, n > 0 ? (size_t)n : 0); }
+
+    char* buf = nullptr;
+    unsigned int len = 0;
+};
+
+class Print {
+public:
+    virtual ~Print() = default;
+    virtual size_t write(uint8_t c) { return write(&c, 1); }
+    virtual size_t write(const uint8_t*, size_t size) { return size; }
+    size_t print(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+    size_t print(int value) { return print(String(value).c_str()); }
+    size_t println(const char* s = "") { return print(s) + print("\n"); }
+    size_t println(const String& s) { return println(s.c_str()); }
+    size_t println(int value) { return println(String(value).c_str()); }
+    size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+
+// Wyjście szeregowe trafia na stderr (gdy hostSerialEcho) albo jest pomijane
+class HardwareSerial : public Print {
+public:
+    void begin(long) {}
+    int available() { return 0; }
+    void flush() {}
+    int availableForWrite() { return 4096; }
+    size_t write(const uint8_t* data, size_t size) override;
+    using Print::write;
+};
+extern HardwareSerial Serial;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned us);
+void yield();
+
+// Piny: zapis zapamiętywany, odczyt zwraca ostatni zapis albo HIGH (podciągnięcie)
+int digitalRead(int pin);
+void digitalWrite(int pin, int value);
+void pinMode(int pin, int mode);
+void attachInterrupt(int, void (*)(), int);
+
+class EspClass {
+public:
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+    uint32_t getMaxAllocHeap();
+    void restart();
+    uint32_t getCycleCount();
+    uint32_t getCpuFreqMHz() { return 160; }
+    uint64_t getEfuseMac();
+};
+extern EspClass ESP;
+
+extern "C" size_t strlcpy(char* dst, const char* src, size_t size);
+void configTzTime(const char* tz, const char* server1, const char* server2 = nullptr, const char* server3 = nullptr);
+
+#include "freertos/FreeRTOS.h"
+
+// --- Sterowanie warstwą z narzędzi hosta ---
+
+// Przesuwa zegar symulowany (millis/micros i czas ścienny time())
+void hostAdvance(uint32_t ms);
+// Cofa zegar symulowany do podanej chwili - każdy przebieg narzędzia zaczyna od
+// tego samego millis(), więc wynik nie zależy od poprzednich przebiegów
+void hostSetMillis(uint32_t ms);
+// Ustawia czas ścienny (sekundy UNIX) dla bieżącej chwili zegara symulowanego
+void hostSetEpoch(int64_t epoch);
+void hostSerialEcho(bool on);
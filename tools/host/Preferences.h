@@ -0,0 +1,55 @@
+// Zastępcze NVS: przestrzenie nazw w pamięci procesu, znikają po jego zakończeniu
+#pragma once
+#include <Arduino.h>
+#include <map>
+#include <string>
+#include <vector>
+
+class Preferences {
+public:
+    bool begin(const char* name, bool = false) { ns = name; return true; }
+    void end() {}
+
+    bool isKey(const char* key) { return store().count(path(key)) != 0; }
+    size_t getBytesLength(const char* key) { auto it = store().find(path(key)); return it == store().end() ? 0 : it->second.size(); }
+    size_t getBytes(const char* key, void* out, size_t size) {
+        auto it = store().find(path(key));
+        if (it == store().end() || it->second.size() > size) return 0;
+        memcpy(out, it->second.data(), it->second.size());
+        return it->second.size();
+    }
+    size_t putBytes(const char* key, const void* data, size_t size) {
+        store()[path(key)].assign((const uint8_t*)data, (const uint8_t*)data + size);
+        return size;
+    }
+
+    bool getBool(const char* key, bool def = false) { return get<uint8_t>(key, def) != 0; }
+    int getInt(const char* key, int def = 0) { return get<int32_t>(key, def); }
+    uint32_t getUInt(const char* key, uint32_t def = 0) { return get<uint32_t>(key, def); }
+    uint8_t getUChar(const char* key, uint8_t def = 0) { return get<uint8_t>(key, def); }
+    size_t putBool(const char* key, bool value) { return put<uint8_t>(key, value); }
+    size_t putInt(const char* key, int value) { return put<int32_t>(key, value); }
+    size_t putUInt(const char* key, uint32_t value) { return put<uint32_t>(key, value); }
+    size_t putUChar(const char* key, uint8_t value) { return put<uint8_t>(key, value); }
+
+    String getString(const char* key, String def = String()) {
+        auto it = store().find(path(key));
+        if (it == store().end()) return def;
+        return String(std::string(it->second.begin(), it->second.end()).c_str());
+    }
+    size_t putString(const char* key, String value) { return putBytes(key, value.c_str(), value.length()); }
+
+private:
+    static std::map<std::string, std::vector<uint8_t>>& store() {
+        static std::map<std::string, std::vector<uint8_t>> nvs;
+        return nvs;
+    }
+    std::string path(const char* key) const { return ns + "/" + key; }
+    template <typename T> T get(const char* key, T def) {
+        T value;
+        return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value : def;
+    }
+    template <typename T> size_t put(const char* key, T value) { return putBytes(key, &value, sizeof(value)); }
+
+    std::string ns;
+};
@@ -0,0 +1,46 @@
+// Zastępczy klient MQTT: połączenie zawsze się udaje, publikacje są liczone,
+// a wiadomości od brokera podaje narzędzie (hostDeliver)
+#pragma once
+#include "WiFi.h"
+
+class PubSubClient {
+public:
+    typedef std::function<void(char*, uint8_t*, unsigned int)> Callback;
+
+    explicit PubSubClient(Client&) { current = this; }
+    PubSubClient& setServer(const char*, uint16_t) { return *this; }
+    PubSubClient& setCallback(Callback cb) { callback = cb; return *this; }
+    bool setBufferSize(uint16_t) { return true; }
+
+    bool connect(const char*, const char*, const char*) { isConnected = true; return true; }
+    bool connected() { return isConnected; }
+    bool loop() { return isConnected; }
+    int state() { return isConnected ? 0 : -1; }
+    bool subscribe(const char*) { return isConnected; }
+
+    bool publish(const char* topic, const uint8_t* payload, unsigned int length, bool = false) {
+        messages++;
+        bytesPublished += strlen(topic) + length;
+        return isConnected;
+    }
+    bool publish(const char* topic, const char* payload, bool retained = false) {
+        return publish(topic, (const uint8_t*)payload, strlen(payload), retained);
+    }
+
+    // --- Narzędzia hosta ---
+
+    static PubSubClient* hostInstance() { return current; }
+    void hostDeliver(const char* topic, const uint8_t* payload, unsigned int length) {
+        if (callback) callback(const_cast<char*>(topic), const_cast<uint8_t*>(payload), length);
+    }
+    // Temat + dane wszystkich publikacji (bez nagłówków pakietu)
+    size_t hostBytesPublished() const { return bytesPublished; }
+    uint32_t hostMessages() const { return messages; }
+
+private:
+    static inline PubSubClient* current = nullptr;
+    Callback callback;
+    bool isConnected = false;
+    size_t bytesPublished = 0;
+    uint32_t messages = 0;
+};
@@ -0,0 +1,14 @@
+#pragma once
+#include <Arduino.h>
+
+#define UPDATE_SIZE_UNKNOWN 0xffffffff
+
+class UpdateClass {
+public:
+    bool begin(size_t) { return false; }
+    size_t write(uint8_t*, size_t) { return 0; }
+    bool end(bool) { return false; }
+    bool hasError() { return true; }
+    void printError(Print&) {}
+};
+extern UpdateClass Update;
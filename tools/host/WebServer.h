@@ -0,0 +1,93 @@
+// Zastępczy WebServer: obsługi wywołuje narzędzie (hostRequest), odpowiedź
+// nie trafia nigdzie - liczone są tylko wysłane bajty
+#pragma once
+#include "WiFi.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+enum HTTPMethod { HTTP_GET, HTTP_POST, HTTP_ANY };
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+enum { UPLOAD_FILE_START, UPLOAD_FILE_WRITE, UPLOAD_FILE_END };
+
+struct HTTPUpload {
+    int status;
+    String filename;
+    uint8_t* buf;
+    size_t currentSize;
+    size_t totalSize;
+};
+
+class WebServer {
+public:
+    explicit WebServer(int) { current = this; }
+
+    void on(const char* uri, HTTPMethod method, std::function<void()> handler) { routes.push_back({ uri, method, handler }); }
+    void on(const char* uri, HTTPMethod method, std::function<void()> handler, std::function<void()>) { on(uri, method, handler); }
+    void begin() {}
+    void handleClient() {}
+
+    void sendHeader(const String&, const String&, bool = false) {}
+    void setContentLength(size_t) {}
+    void send(int code, const char* = "", const String& content = String()) { status = code; bytesSent += content.length(); }
+    void send(int code, const char*, const char* content) { status = code; bytesSent += strlen(content); }
+    void sendContent(const String& content) { bytesSent += content.length(); }
+    void sendContent(const char*, size_t length) { bytesSent += length; }
+    void sendContent_P(PGM_P content) { bytesSent += strlen(content); }
+    void sendContent_P(PGM_P, size_t length) { bytesSent += length; }
+    WiFiClient client() { return WiFiClient(); }
+
+    HTTPMethod method() { return requestMethod; }
+    bool hasArg(const char* name) { return findArg(name) != nullptr; }
+    String arg(const char* name) { const std::string* value = findArg(name); return String(value ? value->c_str() : ""); }
+    HTTPUpload& upload() { return uploadState; }
+
+    // --- Narzędzia hosta ---
+
+    // Ostatnio utworzony serwer (moduły trzymają go jako prywatne pole)
+    static WebServer* hostInstance() { return current; }
+
+    // Żądanie jak od klienta; argumenty w postaci "a=1&b=2". Kod HTTP albo 404.
+    int hostRequest(HTTPMethod method, const char* uri, const char* query = "") {
+        requestMethod = method;
+        args.clear();
+        for (const char* p = query; *p;) {
+            const char* end = strchr(p, '&');
+            std::string pair(p, end ? (size_t)(end - p) : strlen(p));
+            size_t eq = pair.find('=');
+            args.emplace_back(pair.substr(0, eq), eq == std::string::npos ? "" : pair.substr(eq + 1));
+            p = end ? end + 1 : p + pair.size();
+        }
+        for (const Route& route : routes) {
+            if (route.uri == uri && (route.method == method || route.method == HTTP_ANY)) {
+                status = 200;
+                route.handler();
+                return status;
+            }
+        }
+        return 404;
+    }
+    size_t hostBytesSent() const { return bytesSent; }
+
+private:
+    struct Route {
+        std::string uri;
+        HTTPMethod method;
+        std::function<void()> handler;
+    };
+
+    const std::string* findArg(const char* name) const {
+        for (const auto& a : args) {
+            if (a.first == name) return &a.second;
+        }
+        return nullptr;
+    }
+
+    static inline WebServer* current = nullptr;
+    std::vector<Route> routes;
+    std::vector<std::pair<std::string, std::string>> args;
+    HTTPMethod requestMethod = HTTP_GET;
+    HTTPUpload uploadState = {};
+    int status = 0;
+    size_t bytesSent = 0;
+};
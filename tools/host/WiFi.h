@@ -0,0 +1,51 @@
+// Zastępcze WiFi: host nigdy nie jest połączony, więc ujścia sieciowe milczą
+#pragma once
+#include <Arduino.h>
+
+class IPAddress {
+public:
+    IPAddress() = default;
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : addr(a | b << 8 | c << 16 | (uint32_t)d << 24) {}
+    IPAddress(uint32_t addr) : addr(addr) {}
+    String toString() const {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%u.%u.%u.%u", (unsigned)(addr & 0xff), (unsigned)(addr >> 8 & 0xff),
+                 (unsigned)(addr >> 16 & 0xff), (unsigned)(addr >> 24));
+        return String(buf);
+    }
+    bool fromString(const char* s) {
+        unsigned a, b, c, d;
+        if (sscanf(s, "%u.%u.%u.%u", &a, &b, &c, &d) != 4 || a > 255 || b > 255 || c > 255 || d > 255) return false;
+        addr = a | b << 8 | c << 16 | d << 24;
+        return true;
+    }
+    bool fromString(const String& s) { return fromString(s.c_str()); }
+    operator uint32_t() const { return addr; }
+
+private:
+    uint32_t addr = 0;
+};
+
+class Client : public Print {
+public:
+    virtual int connected() { return 0; }
+    void stop() {}
+    void setTimeout(int) {}
+};
+class WiFiClient : public Client {};
+
+#define WL_CONNECTED 3
+#define WL_DISCONNECTED 6
+
+class WiFiClass {
+public:
+    int status() { return hostStatus; }
+    IPAddress localIP() { return IPAddress(); }
+    void begin(const char*, const char*) {}
+    void softAP(const char*, const char*) {}
+    String macAddress() { return String("00:00:00:00:00:00"); }
+    void setSleep(bool) {}
+
+    int hostStatus = WL_DISCONNECTED; // narzędzia hosta: WL_CONNECTED włącza syslog
+};
+extern WiFiClass WiFi;
@@ -0,0 +1,113 @@
+// Zastępczy WiFiUDP na gniazdach POSIX: datagramy naprawdę wychodzą i przychodzą
+// (syslog z loggera, beacony floty), więc narzędzie może je odebrać na 127.0.0.1
+// albo w grupie multicast. Gniazdo jest nieblokujące jak na ESP32.
+#pragma once
+#include "WiFi.h"
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+class WiFiUDP : public Print {
+public:
+    // Interfejs dla multicastu (dołączenie do grupy i wysyłka); 0 = domyślny
+    static inline IPAddress hostMulticastIf;
+
+    ~WiFiUDP() { stop(); }
+
+    uint8_t begin(uint16_t port) { return bindTo(port) ? 1 : 0; }
+    uint8_t beginMulticast(IPAddress group, uint16_t port) {
+        if (!bindTo(port)) return 0;
+        ip_mreq request{};
+        request.imr_multiaddr.s_addr = (uint32_t)group;
+        request.imr_interface.s_addr = (uint32_t)hostMulticastIf;
+        if (setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &request, sizeof(request)) < 0) {
+            stop();
+            return 0;
+        }
+        return 1;
+    }
+    int beginPacket(IPAddress ip, uint16_t port) {
+        if (fd < 0 && !open()) return 0;
+        target = address(ip, port);
+        txLength = 0;
+        return 1;
+    }
+    int beginPacket(const char* host, uint16_t port) {
+        IPAddress ip;
+        return ip.fromString(host) ? beginPacket(ip, port) : 0;
+    }
+    int endPacket() {
+        ssize_t sent = sendto(fd, txBuffer, txLength, 0, (const sockaddr*)&target, sizeof(target));
+        txLength = 0;
+        return sent >= 0 ? 1 : 0;
+    }
+    size_t write(const uint8_t* data, size_t size) override {
+        if (size > sizeof(txBuffer) - txLength) size = sizeof(txBuffer) - txLength;
+        memcpy(txBuffer + txLength, data, size);
+        txLength += size;
+        return size;
+    }
+    using Print::write;
+
+    int parsePacket() {
+        if (fd < 0) return 0;
+        socklen_t length = sizeof(remote);
+        ssize_t received = recvfrom(fd, rxBuffer, sizeof(rxBuffer), 0, (sockaddr*)&remote, &length);
+        rxLength = received > 0 ? (size_t)received : 0;
+        rxPos = 0;
+        return (int)rxLength;
+    }
+    int read(uint8_t* out, size_t size) {
+        if (size > rxLength - rxPos) size = rxLength - rxPos;
+        memcpy(out, rxBuffer + rxPos, size);
+        rxPos += size;
+        return (int)size;
+    }
+    IPAddress remoteIP() { return IPAddress((uint32_t)remote.sin_addr.s_addr); }
+    void stop() {
+        if (fd >= 0) close(fd);
+        fd = -1;
+    }
+
+private:
+    static sockaddr_in address(uint32_t ip, uint16_t port) {
+        sockaddr_in result{};
+        result.sin_family = AF_INET;
+        result.sin_addr.s_addr = ip;
+        result.sin_port = htons(port);
+        return result;
+    }
+    bool open() {
+        fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd < 0) return false;
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
+        in_addr iface{};
+        iface.s_addr = (uint32_t)hostMulticastIf;
+        setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &iface, sizeof(iface));
+        return true;
+    }
+    bool bindTo(uint16_t port) {
+        stop();
+        if (!open()) return false;
+        sockaddr_in local = address(INADDR_ANY, port);
+        if (bind(fd, (const sockaddr*)&local, sizeof(local)) < 0) {
+            stop();
+            return false;
+        }
+        return true;
+    }
+
+    int fd = -1;
+    sockaddr_in target{};
+    sockaddr_in remote{};
+    uint8_t txBuffer[1472];
+    size_t txLength = 0;
+    uint8_t rxBuffer[1472];
+    size_t rxLength = 0;
+    size_t rxPos = 0;
+};
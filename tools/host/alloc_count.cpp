@@ -0,0 +1,34 @@
+#include "alloc_count.h"
+#include <stddef.h>
+
+// Właściwe implementacje glibc; nasze symbole przesłaniają malloc w całym procesie
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+extern "C" void __libc_free(void* ptr);
+
+static AllocCounters counters;
+
+AllocCounters hostAllocCounters() { return counters; }
+
+extern "C" void* malloc(size_t size) {
+    counters.calls++;
+    counters.bytes += size;
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+    counters.calls++;
+    counters.bytes += count * size;
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size) {
+    if (size) {
+        counters.calls++;
+        counters.bytes += size;
+    }
+    return __libc_realloc(ptr, size);
+}
+
+extern "C" void free(void* ptr) { __libc_free(ptr); }
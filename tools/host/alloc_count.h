@@ -0,0 +1,12 @@
+// Licznik alokacji sterty procesu. Podmienia malloc/calloc/realloc, więc
+// obejmuje też operator new i String; linkowany tylko do narzędzi, które
+// sprawdzają alokacje (nie jest częścią zastępczej warstwy Arduino).
+#pragma once
+#include <stdint.h>
+
+struct AllocCounters {
+    uint64_t calls; // malloc, calloc i realloc z niezerowym rozmiarem
+    uint64_t bytes; // żądane bajty
+};
+
+AllocCounters hostAllocCounters();
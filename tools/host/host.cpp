@@ -0,0 +1,153 @@
+// Implementacja zastępczej warstwy Arduino/FreeRTOS dla narzędzi hosta
+#include <Arduino.h>
+#include <WiFi.h>
+#include <ESPmDNS.h>
+#include <Update.h>
+#include <chrono>
+#include <stdarg.h>
+#include <time.h>
+#include <vector>
+
+HardwareSerial Serial;
+EspClass ESP;
+WiFiClass WiFi;
+MDNSResponder MDNS;
+UpdateClass Update;
+
+// --- Zegar symulowany ---
+
+static uint64_t simMicros = 0;
+static int64_t epochAtZero = 0; // 0 = zegar ścienny nieustawiony (jak przed NTP)
+static bool serialEcho = false;
+
+void hostAdvance(uint32_t ms) { simMicros += (uint64_t)ms * 1000; }
+void hostSetMillis(uint32_t ms) { simMicros = (uint64_t)ms * 1000; }
+void hostSetEpoch(int64_t epoch) { epochAtZero = epoch - (int64_t)(simMicros / 1000000); }
+void hostSerialEcho(bool on) { serialEcho = on; }
+
+unsigned long millis() { return (unsigned long)(uint32_t)(simMicros / 1000); }
+unsigned long micros() { return (unsigned long)(uint32_t)simMicros; }
+void delay(unsigned long ms) { hostAdvance(ms); }
+void delayMicroseconds(unsigned us) { simMicros += us; }
+void yield() {}
+
+// Moduły pytają o czas lokalny przez time() - podmieniamy go na zegar symulowany
+extern "C" time_t time(time_t* out) noexcept {
+    time_t now = epochAtZero ? (time_t)(epochAtZero + (int64_t)(simMicros / 1000000)) : 0;
+    if (out) *out = now;
+    return now;
+}
+
+void configTzTime(const char* tz, const char*, const char*, const char*) {
+    setenv("TZ", tz, 1);
+    tzset();
+}
+
+// --- Wyjście szeregowe ---
+
+size_t HardwareSerial::write(const uint8_t* data, size_t size) {
+    if (serialEcho) fwrite(data, 1, size, stderr);
+    return size;
+}
+
+size_t Print::printf(const char* fmt, ...) {
+    char buf[256];
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    if (n < 0) return 0;
+    return write((const uint8_t*)buf, (size_t)n < sizeof(buf) ? (size_t)n : sizeof(buf) - 1);
+}
+
+// --- Piny ---
+
+static int pinValues[64];
+static bool pinsInitialized = false;
+
+static int& pinValue(int pin) {
+    if (!pinsInitialized) {
+        for (int& v : pinValues) v = HIGH;
+        pinsInitialized = true;
+    }
+    return pinValues[pin & 63];
+}
+
+int digitalRead(int pin) { return pinValue(pin); }
+void digitalWrite(int pin, int value) { pinValue(pin) = value; }
+void pinMode(int, int) {}
+void attachInterrupt(int, void (*)(), int) {}
+
+// --- ESP ---
+
+uint32_t EspClass::getFreeHeap() { return 200000; }
+uint32_t EspClass::getMinFreeHeap() { return 200000; }
+uint32_t EspClass::getMaxAllocHeap() { return 110000; }
+void EspClass::restart() { exit(0); }
+uint64_t EspClass::getEfuseMac() { return 0x0000563412cdab24ULL; }
+
+// Cykle liczone z prawdziwego zegara przy nominalnym taktowaniu - do pomiarów czasu
+uint32_t EspClass::getCycleCount() {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    return (uint32_t)((uint64_t)ns * getCpuFreqMHz() / 1000);
+}
+
+extern "C" size_t strlcpy(char* dst, const char* src, size_t size) {
+    size_t len = strlen(src);
+    if (size) {
+        size_t n = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+
+// --- FreeRTOS ---
+
+TickType_t xTaskGetTickCount() { return (TickType_t)millis(); }
+
+void vTaskDelayUntil(TickType_t* previousWake, TickType_t period) {
+    *previousWake += period;
+    TickType_t now = xTaskGetTickCount();
+    if ((int32_t)(*previousWake - now) > 0) hostAdvance(*previousWake - now);
+}
+
+void vTaskDelay(TickType_t ticks) { hostAdvance(ticks); }
+
+// Zadania nie startują: ich pętle są nieskończone, a narzędzie samo steruje czasem
+BaseType_t xTaskCreate(void (*)(void*), const char*, uint32_t, void*, UBaseType_t, TaskHandle_t* handle) {
+    static int dummyTask;
+    if (handle) *handle = &dummyTask;
+    return pdPASS;
+}
+
+
+// Pamięć kolejki przydzielana raz przy tworzeniu, jak w FreeRTOS
+struct HostQueue {
+    size_t itemSize;
+    size_t length;
+    size_t head;
+    size_t count;
+    std::vector<uint8_t> storage;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    return new HostQueue{ itemSize, length, 0, 0, std::vector<uint8_t>((size_t)length * itemSize) };
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t) {
+    if (queue->count >= queue->length) return pdFALSE;
+    size_t slot = (queue->head + queue->count) % queue->length;
+    memcpy(&queue->storage[slot * queue->itemSize], item, queue->itemSize);
+    queue->count++;
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t) {
+    if (queue->count == 0) return pdFALSE;
+    memcpy(item, &queue->storage[queue->head * queue->itemSize], queue->itemSize);
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    return pdTRUE;
+}
@@ -0,0 +1,155 @@
+#include "hot_paths.h"
+#include "alloc_count.h"
+#include <time.h>
+#include <HTTPClient.h>
+#include <PubSubClient.h>
+#include <WebServer.h>
+#include "WebInterface.h"
+
+// Te same moduły co w szkicu, na zastępczej warstwie z tools/host
+static Preferences preferences;
+static SystemState systemState;
+static Notifier notifier(systemState);
+static PumpController pumpController(systemState, notifier);
+static WaterMonitorMQTT waterMQTT;
+static Scheduler scheduler;
+static Fleet fleet(systemState);
+static WebInterface webInterface(systemState, waterMQTT, pumpController, preferences, scheduler, fleet);
+
+// Chwila stałego stanu: czas pracy trafia do strony i telemetrii MQTT
+static const uint32_t FIXED_MILLIS = 10000;
+static const int64_t FIXED_EPOCH = 1767571200; // 2026-01-05 00:00 UTC
+
+static const char NOTICE[] = "Pompa została automatycznie włączona - niski poziom wody";
+static const char EVENT[] = "Automatyczne włączenie pompy (brak wody)";
+
+// Stały stan: pompa pracuje, woda między dolnym a środkowym czujnikiem,
+// pełna historia zdarzeń - rozmiar stron nie zależy od kolejności przypadków
+static void fixedState() {
+    hostSetMillis(FIXED_MILLIS);
+    hostSetEpoch(FIXED_EPOCH);
+    logger.drain();
+
+    ControlState state;
+    state.pumpOn = true;
+    state.sensorLowState = true;
+    state.waterLevel = 30;
+    state.midSensorPresent = true;
+    state.rawInputs = PUMP_IN_LOW;
+    systemState.control.publish(state);
+    systemState.wifiConnected = true;
+
+    for (int i = 0; i < EVENT_LIMIT; i++) {
+        snprintf(systemState.events[i], EVENT_TEXT_LEN, "Zdarzenie testowe %02d: przełączenie pompy", i);
+    }
+    systemState.eventIndex = 0;
+}
+
+static void textFormat() {
+    fixedState();
+    waterMQTT.restartSequence();
+    waterMQTT.setConfig("broker.test", 1883, "", "", false);
+}
+
+static void cborFormat() {
+    fixedState();
+    waterMQTT.restartSequence();
+    waterMQTT.setConfig("broker.test", 1883, "", "", true);
+}
+
+static size_t webRequest(const char* uri) {
+    WebServer* server = WebServer::hostInstance();
+    size_t before = server->hostBytesSent();
+    server->hostRequest(HTTP_GET, uri);
+    return server->hostBytesSent() - before;
+}
+
+static size_t publishedBytes(void (*action)()) {
+    PubSubClient* client = PubSubClient::hostInstance();
+    size_t before = client->hostBytesPublished();
+    action();
+    return client->hostBytesPublished() - before;
+}
+
+const HotPath HOT_PATHS[] = {
+    { "sendPage", HEAP_WEB, fixedState, []() -> size_t { return webRequest("/"); }, 0 },
+    { "handleLog", HEAP_WEB, fixedState, []() -> size_t { return webRequest("/log"); }, 0 },
+    { "urlEncode", HEAP_NOTIFIER, fixedState, []() -> size_t {
+        char buffer[768]; // jak Notifier::postBuffer
+        TextBuffer out(buffer, sizeof(buffer));
+        out.appendUrlEncoded(NOTICE);
+        return out.length();
+    }, 0 },
+    { "sendPushover", HEAP_NOTIFIER, fixedState, []() -> size_t {
+        hostAdvance(30001); // poza oknem tłumienia duplikatów
+        size_t before = HTTPClient::hostBytesPosted;
+        notifier.sendPushover(NOTICE);
+        return HTTPClient::hostBytesPosted - before;
+    }, 1 }, // HTTPClient::begin() przyjmuje URL przez wartość (kopia String)
+    { "mqttCallback", HEAP_MQTT, fixedState, []() -> size_t {
+        // Właściwy temat, nieznana wartość - pełna ścieżka bez polecenia dla pompy
+        static const char topic[] = "homeassistant/sensor/water_monitor/pump/set";
+        static const uint8_t payload[] = { 'N', 'O', 'O', 'P' };
+        PubSubClient::hostInstance()->hostDeliver(topic, payload, sizeof(payload));
+        return 0;
+    }, 0 },
+    // Numer rekordu rośnie z każdą publikacją; partie od zera trzymają go
+    // w jednym bajcie CBOR, więc bajty na wywołanie nie zależą od ich liczby
+    { "sendData", HEAP_MQTT, textFormat, []() -> size_t {
+        return publishedBytes([]() { waterMQTT.sendData(); });
+    }, 0, []() { waterMQTT.restartSequence(); } },
+    { "sendDataCbor", HEAP_MQTT, cborFormat, []() -> size_t {
+        return publishedBytes([]() { waterMQTT.sendData(); });
+    }, 0, []() { waterMQTT.restartSequence(); } },
+    // Zadanie log_drain na hoście nie działa - bez opróżniania pierścień zapełniłby
+    // się po LOG_RING_SIZE wpisach i mierzona byłaby ścieżka odrzucenia
+    { "addEvent", HEAP_EVENTS, fixedState, []() -> size_t {
+        systemState.addEvent(EVENT);
+        return sizeof(EVENT) - 1;
+    }, 0, []() { logger.drain(); } },
+};
+
+const int HOT_PATH_COUNT = sizeof(HOT_PATHS) / sizeof(HOT_PATHS[0]);
+
+// Czas procesora wątku - wywłaszczenia przez inne procesy nie wliczają się do pomiaru
+static double threadNs() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+HotPathSeries hotPathSeries(const HotPath& path, int n) {
+    HotPathSeries series = {};
+    for (int done = 0; done < n; ) {
+        int batch = path.between && n - done > HOT_PATH_BATCH ? HOT_PATH_BATCH : n - done;
+        AllocCounters before = hostAllocCounters();
+        double start = threadNs();
+        for (int i = 0; i < batch; i++) series.bytes += path.run();
+        series.ns += threadNs() - start;
+        series.allocs += hostAllocCounters().calls - before.calls;
+        done += batch;
+        if (path.between) path.between();
+    }
+    return series;
+}
+
+void hotPathsBegin() {
+    hostSetMillis(FIXED_MILLIS);
+    hostSetEpoch(FIXED_EPOCH);
+
+    preferences.begin("config", false);
+    preferences.putString("pushuser", "u000000000000000000000000000000");
+    preferences.putString("pushtoken", "a000000000000000000000000000000");
+    preferences.end();
+    preferences.begin("mqtt", false);
+    preferences.putString("server", "broker.test");
+    preferences.end();
+
+    notifier.begin("u000000000000000000000000000000", "a000000000000000000000000000000");
+    waterMQTT.begin(preferences);
+    waterMQTT.setStateSource(&systemState.control);
+    waterMQTT.setPumpController(&pumpController);
+    waterMQTT.loop(); // połączenie z brokerem zastępczym
+    webInterface.begin();
+    fixedState();
+}
@@ -0,0 +1,34 @@
+// Gorące ścieżki firmware uruchamiane na hoście na stałym stanie: strona
+// główna i historia (przez zarejestrowane obsługi WebServer), callback
+// i publikacja MQTT, Pushover i dziennik zdarzeń. Wspólne dla heap_check
+// i hotpath_bench.
+#pragma once
+#include <stddef.h>
+#include "HeapMonitor.h"
+
+struct HotPath {
+    const char* name;
+    HeapSubsystem subsystem;
+    void (*prepare)(); // przywraca stały stan przed serią wywołań (może alokować)
+    size_t (*run)();   // jedno wywołanie; zwraca bajty wyjścia
+    uint8_t allowedAllocs; // alokacje wymuszone przez API biblioteki (nie przez nasz kod)
+    // Co najwyżej HOT_PATH_BATCH wywołań, potem between() poza pomiarem - np.
+    // opróżnienie pierścienia logów, które na urządzeniu robi osobne zadanie
+    void (*between)() = nullptr;
+};
+
+static const int HOT_PATH_BATCH = 16;
+
+extern const HotPath HOT_PATHS[];
+extern const int HOT_PATH_COUNT;
+
+// Raz na starcie narzędzia: konfiguracja w NVS, połączenie MQTT, begin() modułów
+void hotPathsBegin();
+// Seria n wywołań w partiach z between() pomiędzy. Alokacje i czas procesora
+// wątku [ns] liczone są tylko dla samych wywołań, bez between().
+struct HotPathSeries {
+    size_t bytes;
+    uint64_t allocs;
+    double ns;
+};
+HotPathSeries hotPathSeries(const HotPath& path, int n);
@@ -0,0 +1,152 @@
+// Mikrobenchmark gorących ścieżek na hoście (ścieżki i stały stan z hot_paths.cpp).
+// Dla każdej ścieżki: czas procesora na wywołanie [ns] (najlepsza z kilku serii),
+// alokacje i bajty wyjścia na wywołanie. Wynik zapisuje jako JSON (jeden
+// przypadek w wierszu) i porównuje z zapisaną bazą w tym samym formacie.
+//
+//   hotpath_bench [--out wynik.json] [--baseline baza.json] [--threshold 20] [--iterations 2000]
+//
+// Regresja: czas lub rozmiar wyjścia ponad próg [%] względem bazy albo
+// jakakolwiek dodatkowa alokacja na wywołanie. Kod wyjścia 1 przy regresji.
+
+#include "hot_paths.h"
+#include "alloc_count.h"
+
+static const int REPEATS = 15;
+static const int MAX_CASES = 16;
+
+struct BenchRow {
+    char name[24];
+    double ns;
+    double allocs;
+    double bytes;
+};
+
+// Serie wszystkich przypadków na przemian, dla każdego najlepsza seria:
+// chwilowe obciążenie maszyny rozkłada się na wszystkie przypadki zamiast psuć jeden
+static int measureAll(BenchRow* rows, int iterations) {
+    int count = HOT_PATH_COUNT < MAX_CASES ? HOT_PATH_COUNT : MAX_CASES;
+    size_t bytes[MAX_CASES] = {};
+    uint64_t allocs[MAX_CASES] = {};
+    for (int i = 0; i < count; i++) {
+        rows[i] = {};
+        strlcpy(rows[i].name, HOT_PATHS[i].name, sizeof(rows[i].name));
+        rows[i].ns = 1e18;
+        HOT_PATHS[i].prepare();
+        HOT_PATHS[i].run(); // rozgrzanie: pierwsze wywołania, bufory statyczne
+    }
+    for (int r = 0; r < REPEATS; r++) {
+        for (int i = 0; i < count; i++) {
+            const HotPath& path = HOT_PATHS[i];
+            path.prepare();
+            HotPathSeries series = hotPathSeries(path, iterations);
+            bytes[i] += series.bytes;
+            allocs[i] += series.allocs;
+            double ns = series.ns / iterations;
+            if (ns < rows[i].ns) rows[i].ns = ns;
+        }
+    }
+    int calls = REPEATS * iterations;
+    for (int i = 0; i < count; i++) {
+        rows[i].allocs = (double)allocs[i] / calls;
+        rows[i].bytes = (double)bytes[i] / calls;
+    }
+    return count;
+}
+
+// Czyta bazę zapisaną przez --out: po jednym przypadku w wierszu
+static int loadBaseline(const char* path, BenchRow* rows) {
+    FILE* f = fopen(path, "r");
+    if (!f) return -1;
+    int count = 0;
+    char line[256];
+    while (count < MAX_CASES && fgets(line, sizeof(line), f)) {
+        const char* entry = strstr(line, "{\"name\":\"");
+        BenchRow& row = rows[count];
+        if (entry && sscanf(entry, "{\"name\":\"%23[^\"]\",\"ns\":%lf,\"allocs\":%lf,\"bytes\":%lf",
+                            row.name, &row.ns, &row.allocs, &row.bytes) == 4) {
+            count++;
+        }
+    }
+    fclose(f);
+    return count;
+}
+
+static const BenchRow* findRow(const BenchRow* rows, int count, const char* name) {
+    for (int i = 0; i < count; i++) {
+        if (strcmp(rows[i].name, name) == 0) return &rows[i];
+    }
+    return nullptr;
+}
+
+static bool regressed(const BenchRow& row, const BenchRow* base, int thresholdPercent) {
+    if (!base) return false;
+    double limit = 1.0 + thresholdPercent / 100.0;
+    return row.ns > base->ns * limit || row.bytes > base->bytes * limit || row.allocs > base->allocs;
+}
+
+int main(int argc, char** argv) {
+    const char* outPath = nullptr;
+    const char* baselinePath = nullptr;
+    int thresholdPercent = 20;
+    int iterations = 2000;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--out") == 0) outPath = argv[i + 1];
+        else if (strcmp(argv[i], "--baseline") == 0) baselinePath = argv[i + 1];
+        else if (strcmp(argv[i], "--threshold") == 0) thresholdPercent = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--iterations") == 0) iterations = atoi(argv[i + 1]);
+        else {
+            fprintf(stderr, "nieznana opcja: %s\n", argv[i]);
+            return 2;
+        }
+    }
+    if (iterations < 1) iterations = 1;
+
+    BenchRow base[MAX_CASES];
+    int baseCount = 0;
+    if (baselinePath) {
+        baseCount = loadBaseline(baselinePath, base);
+        if (baseCount < 0) {
+            fprintf(stderr, "brak bazy: %s\n", baselinePath);
+            return 2;
+        }
+    }
+
+    hotPathsBegin();
+    BenchRow rows[MAX_CASES];
+    int count = measureAll(rows, iterations);
+    int regressions = 0;
+    printf("%-14s %10s %8s %8s %10s\n", "przypadek", "ns", "alokacje", "bajty", "baza ns");
+    for (int i = 0; i < count; i++) {
+        const BenchRow& row = rows[i];
+        const BenchRow* b = findRow(base, baseCount, row.name);
+        bool bad = regressed(row, b, thresholdPercent);
+        if (bad) regressions++;
+        char baseNs[16] = "-";
+        if (b) snprintf(baseNs, sizeof(baseNs), "%.0f", b->ns);
+        printf("%-14s %10.0f %8.2f %8.0f %10s%s\n", row.name, row.ns, row.allocs, row.bytes, baseNs,
+               bad ? "  REGRESJA" : "");
+    }
+
+    if (outPath) {
+        FILE* f = fopen(outPath, "w");
+        if (!f) {
+            fprintf(stderr, "nie można zapisać: %s\n", outPath);
+            return 2;
+        }
+        fprintf(f, "{\"iterations\":%d,\"repeats\":%d,\"thresholdPct\":%d,\"regressions\":%d,\"results\":[\n",
+                iterations, REPEATS, thresholdPercent, regressions);
+        for (int i = 0; i < count; i++) {
+            const BenchRow& row = rows[i];
+            const BenchRow* b = findRow(base, baseCount, row.name);
+            fprintf(f, "{\"name\":\"%s\",\"ns\":%.1f,\"allocs\":%.2f,\"bytes\":%.0f", row.name, row.ns, row.allocs, row.bytes);
+            if (b) {
+                fprintf(f, ",\"baseNs\":%.1f,\"baseAllocs\":%.2f,\"baseBytes\":%.0f,\"regressed\":%s",
+                        b->ns, b->allocs, b->bytes, regressed(row, b, thresholdPercent) ? "true" : "false");
+            }
+            fprintf(f, "}%s\n", i + 1 < count ? "," : "");
+        }
+        fprintf(f, "]}\n");
+        fclose(f);
+    }
+    return regressions ? 1 : 0;
+}
@@ -0,0 +1,113 @@
+// Kontrola loggera na hoście: prawdziwy Logger wysyła syslog przez zastępczy
+// WiFiUDP na gniazdach, a narzędzie odbiera datagramy na 127.0.0.1. Pierścień
+// opróżnia ręcznie (Logger::drain), bo zadanie log_drain na hoście nie działa.
+// Sprawdza nagłówek RFC 5424, próg ujścia oraz to, że pełny pierścień odrzuca
+// wpisy (licznik dropped) zamiast czekać. Kod 1 przy błędzie.
+//
+//   make -C tools check
+
+#include "Logger.h"
+#include <chrono>
+#include <poll.h>
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+    printf("%-56s %s\n", what, ok ? "ok" : "BLAD");
+    if (!ok) failures++;
+}
+
+// Odbiornik syslog na 127.0.0.1, port przydziela system
+static int openListener(uint16_t& port) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in local{};
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(local);
+    if (fd < 0 || bind(fd, (const sockaddr*)&local, sizeof(local)) < 0 ||
+        getsockname(fd, (sockaddr*)&local, &length) < 0) {
+        perror("listener");
+        exit(1);
+    }
+    port = ntohs(local.sin_port);
+    return fd;
+}
+
+// Długość datagramu albo -1, gdy nic nie przyszło w timeoutMs
+static int receive(int fd, char* out, size_t size, int timeoutMs) {
+    pollfd waiting = { fd, POLLIN, 0 };
+    if (poll(&waiting, 1, timeoutMs) <= 0) return -1;
+    ssize_t length = recv(fd, out, size - 1, 0);
+    if (length < 0) return -1;
+    out[length] = '\0';
+    return (int)length;
+}
+
+// Licznik z Logger::writeJson (np. "dropped")
+static uint32_t counter(const char* key) {
+    char buf[256];
+    TextBuffer json(buf, sizeof(buf));
+    logger.writeJson(json);
+    char pattern[32];
+    snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+    const char* at = strstr(json.c_str(), pattern);
+    return at ? strtoul(at + strlen(pattern), nullptr, 10) : UINT32_MAX;
+}
+
+int main() {
+    alarm(10); // zablokowany zapis kończy proces zamiast zawiesić make check
+
+    uint16_t port;
+    int fd = openListener(port);
+    WiFi.hostStatus = WL_CONNECTED;
+    logger.setHostName("host");
+    logger.setSinkLevel(LOG_SINK_SERIAL, LOG_OFF);
+    logger.setSyslogServer(IPAddress(127, 0, 0, 1), port);
+
+    char datagram[512];
+    logger.info(LOG_PUMP, "pompa %s", "wlaczona");
+    logger.drain();
+    int length = receive(fd, datagram, sizeof(datagram), 1000);
+    // local0 (16) * 8 + info (6) = 134; TIMESTAMP, PROCID i SD puste
+    static const char expected[] = "<134>1 - host watermonitor - pump - \xEF\xBB\xBFpompa wlaczona";
+    bool header = length == (int)sizeof(expected) - 1 && memcmp(datagram, expected, length) == 0;
+    expect(header, "syslog: <PRI>1 - host watermonitor - MSGID - BOM");
+    if (!header) printf("  odebrano (%d B): %s\n", length, length < 0 ? "-" : datagram);
+
+    uint32_t written = counter("written");
+    logger.debug(LOG_PUMP, "ponizej progu");
+    logger.drain();
+    expect(counter("written") == written && receive(fd, datagram, sizeof(datagram), 100) < 0,
+           "debug ponizej progow ujsc nie trafia do pierscienia");
+
+    // Bez opróżniania: LOG_RING_SIZE wpisów się mieści, nadmiar jest odrzucany
+    static const int EXTRA = 10;
+    uint32_t dropped = counter("dropped");
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < LOG_RING_SIZE + EXTRA; i++) logger.warn(LOG_SYS, "wpis %d", i);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    expect(counter("dropped") - dropped == EXTRA, "pelny pierscien: dropped rosnie o nadmiar");
+    expect(elapsed < std::chrono::milliseconds(50), "pelny pierscien: zapis nie czeka");
+
+    logger.drain();
+    int received = 0;
+    char first[LOG_TEXT_LEN] = "", last[LOG_TEXT_LEN] = "";
+    while (receive(fd, datagram, sizeof(datagram), 100) >= 0) {
+        const char* text = strstr(datagram, "\xEF\xBB\xBF");
+        text = text ? text + 3 : datagram;
+        if (received++ == 0) strlcpy(first, text, sizeof(first));
+        strlcpy(last, text, sizeof(last));
+    }
+    char lastExpected[16];
+    snprintf(lastExpected, sizeof(lastExpected), "wpis %d", LOG_RING_SIZE - 1);
+    expect(received == LOG_RING_SIZE && strcmp(first, "wpis 0") == 0 && strcmp(last, lastExpected) == 0,
+           "po oproznieniu: wpisy sprzed przepelnienia, w kolejnosci");
+
+    logger.error(LOG_SYS, "po przepelnieniu");
+    logger.drain();
+    length = receive(fd, datagram, sizeof(datagram), 1000);
+    expect(length > 0 && strncmp(datagram, "<131>1 ", 7) == 0, "pierscien znow przyjmuje wpisy");
+
+    close(fd);
+    return failures ? 1 : 0;
+}
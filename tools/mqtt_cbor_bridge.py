@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+"""Most MQTT: rekordy CBOR z tematów wm/<węzeł> -> czytelne tematy
+w formacie tekstowym urządzenia (domyślnie homeassistant/sensor/water_monitor/...).
+
+Użycie: python3 mqtt_cbor_bridge.py --host broker.local [--port 1883] [--user U --password P]
+                                   [--base homeassistant/sensor/{node}/]
+Wymaga: pip install paho-mqtt
+"""
+import argparse
+
+import paho.mqtt.client as mqtt
+
+KEY_SCHEMA, KEY_SEQ, KEY_UPTIME_MS, KEY_LEVEL, KEY_SENSORS, KEY_PUMP, KEY_MODE = range(7)
+MODES = {0: "auto", 1: "manual", 2: "test"}
+
+
+def decode(data):
+    """Dekoder podzbioru CBOR używanego przez urządzenie: mapy, uint, bool."""
+    pos = 0
+
+    def item():
+        nonlocal pos
+        head = data[pos]
+        pos += 1
+        major, info = head >> 5, head & 0x1F
+        if head == 0xF4:
+            return False
+        if head == 0xF5:
+            return True
+        if info < 24:
+            value = info
+        else:
+            size = {24: 1, 25: 2, 26: 4, 27: 8}[info]
+            value = int.from_bytes(data[pos:pos + size], "big")
+            pos += size
+        if major == 0:
+            return value
+        if major == 5:
+            return {item(): item() for _ in range(value)}
+        raise ValueError("nieobsługiwany typ CBOR: %d" % major)
+
+    return item()
+
+
+DEFAULT_BASE = "homeassistant/sensor/water_monitor/"  # jak mqttBaseTopic urządzenia
+
+
+def on_message(client, base_template, msg):
+    node = msg.topic.split("/", 1)[1]
+    try:
+        rec = decode(msg.payload)
+    except (IndexError, KeyError, ValueError) as e:
+        print("Błędny rekord z %s: %s" % (msg.topic, e))
+        return
+    if rec.get(KEY_SCHEMA) != 1:
+        print("Nieznany schemat z %s: %r" % (msg.topic, rec.get(KEY_SCHEMA)))
+        return
+    base = base_template.format(node=node)
+    sensors = rec[KEY_SENSORS]
+    out = {
+        "level": str(rec[KEY_LEVEL]),
+        "pump": "ON" if rec[KEY_PUMP] else "OFF",
+        "mode": MODES.get(rec[KEY_MODE], "auto"),
+        "low_sensor": "WET" if sensors & 0x01 else "DRY",
+        "high_sensor": "WET" if sensors & 0x04 else "DRY",
+    }
+    if sensors & 0x10:
+        out["mid_sensor"] = "WET" if sensors & 0x02 else "DRY"
+    for suffix, value in out.items():
+        client.publish(base + suffix, value)
+    print("%s seq=%d uptime=%ds %r" % (node, rec[KEY_SEQ], rec[KEY_UPTIME_MS] // 1000, out))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--host", required=True)
+    parser.add_argument("--port", type=int, default=1883)
+    parser.add_argument("--user")
+    parser.add_argument("--password")
+    parser.add_argument("--base", default=DEFAULT_BASE,
+                        help="temat bazowy; {node} = nazwa węzła (domyślnie jak w formacie tekstowym)")
+    args = parser.parse_args()
+
+    client = mqtt.Client(userdata=args.base)
+    if args.user:
+        client.username_pw_set(args.user, args.password)
+    client.on_connect = lambda c, u, f, rc: c.subscribe("wm/+")
+    client.on_message = on_message
+    client.connect(args.host, args.port)
+    client.loop_forever()
+
+
+if __name__ == "__main__":
+    main()
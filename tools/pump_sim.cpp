@@ -0,0 +1,187 @@
+// Symulacja zbiornika na hoście: odtwarza dobowe profile poboru i napełniania
+// przez prawdziwy PumpController (debouncing, bezpiecznik, PumpPolicy) w trybie
+// histerezy i adaptacyjnym, z czujnikiem środkowym i bez niego.
+// Wypisuje włączenia i blokady zabezpieczeń na dobę oraz czas pracy w szczycie
+// taryfy. Kończy się kodem 1, jeśli w którymkolwiek przebiegu woda zeszła poniżej
+// suchobiegu albo przelała się, albo gdy tryb adaptacyjny ma więcej włączeń lub
+// blokad niż histereza na tym samym profilu.
+//
+//   make -C tools && tools/build/pump_sim [dni]
+
+#include "PumpController.h"
+#include <math.h>
+
+// Zbiornik [l] i pompa [l/s]; czujniki na wysokościach lowAt/midAt/highAt
+struct Tank {
+    double capacity;
+    double lowAt, midAt, highAt;
+    double dryAt;      // poniżej: suchobieg pompy głębinowej - granica dolna
+    double overflowAt; // powyżej: przelew - granica górna
+    double pumpRate;
+};
+
+struct Profile {
+    const char* name;
+    Tank tank;
+    double usage[24]; // średni pobór w danej godzinie [l/s]
+    const char* peakHours;
+};
+
+static const Profile PROFILES[] = {
+    { "dom", { 3000, 600, 1500, 2550, 300, 2700, 0.8 },
+      { 0.02, 0.02, 0.02, 0.02, 0.02, 0.05, 0.5, 0.5, 0.15, 0.12, 0.12, 0.12,
+        0.12, 0.12, 0.12, 0.12, 0.12, 0.15, 0.5, 0.5, 0.5, 0.2, 0.05, 0.02 },
+      "7-13,16-22" },
+    { "ogrod", { 3000, 600, 1500, 2550, 300, 2700, 0.8 },
+      { 0.02, 0.02, 0.02, 0.02, 0.02, 0.3, 0.6, 0.5, 0.12, 0.12, 0.12, 0.12,
+        0.12, 0.12, 0.12, 0.12, 0.12, 0.15, 0.6, 0.65, 0.65, 0.3, 0.05, 0.02 },
+      "7-13,16-22" },
+    { "maly", { 1000, 200, 500, 850, 100, 950, 0.5 },
+      { 0.01, 0.01, 0.01, 0.01, 0.01, 0.05, 0.3, 0.3, 0.1, 0.08, 0.08, 0.08,
+        0.08, 0.08, 0.08, 0.08, 0.08, 0.1, 0.3, 0.3, 0.25, 0.1, 0.03, 0.01 },
+      "6-13,15-22" },
+    // Hydrofor: małe pasmo i duża pompa - w nocy napełnia się szybciej niż
+    // w 30 s, a przy porannym i wieczornym poborze opróżnia się niewiele wolniej.
+    // Histereza wpada tu w blokady zabezpieczeń ("bezpiecznik").
+    { "hydrofor", { 300, 100, 130, 160, 40, 250, 3.0 },
+      { 0.05, 0.05, 0.05, 0.05, 0.05, 0.3, 1.8, 1.8, 0.3, 0.3, 0.3, 0.3,
+        0.3, 0.3, 0.3, 0.3, 0.3, 0.3, 1.8, 1.8, 1.8, 0.3, 0.05, 0.05 },
+      "7-13,16-22" },
+};
+
+static const uint32_t STEP_MS = 10;       // okres zadania sterującego
+static const int64_t START_EPOCH = 1767571200; // 2026-01-05 00:00 UTC (poniedziałek)
+
+// Powtarzalny pseudolosowy rozrzut poboru (ten sam dla obu trybów)
+static uint32_t rngState;
+static double jitter() {
+    rngState = rngState * 1664525u + 1013904223u;
+    return 0.5 + (rngState >> 8) / (double)(1u << 24); // 0.5 .. 1.5
+}
+
+class SimPump : public PumpController {
+public:
+    SimPump(SystemState& state, Notifier& notifier, const Tank& tank, bool midSensor)
+        : PumpController(state, notifier), tank(tank), midSensor(midSensor) {}
+
+    void step() { controlCycle(); }
+
+    double volume = 0;
+    bool relay = false;
+
+protected:
+    // Falowanie lustra wody (+-1% pojemności, okres ~7 s) sprawdza debouncing czujników
+    uint8_t sampleInputs() override {
+        double surface = volume + tank.capacity * 0.01 * sin(millis() / 7000.0 * 2 * M_PI);
+        uint8_t inputs = 0;
+        if (surface >= tank.lowAt) inputs |= PUMP_IN_LOW;
+        if (midSensor && surface >= tank.midAt) inputs |= PUMP_IN_MID;
+        if (surface >= tank.highAt) inputs |= PUMP_IN_HIGH;
+        return inputs;
+    }
+    void writeRelay(bool on) override { relay = on; }
+    const char* profileName() const override { return "sim"; }
+
+private:
+    const Tank& tank;
+    bool midSensor;
+};
+
+struct SimResult {
+    uint32_t starts = 0;
+    uint32_t refusals = 0; // blokady zabezpieczeń (PumpTaskStats::totalRefusals)
+    double runS = 0, peakRunS = 0;
+    double minVolume = 1e9, maxVolume = 0;
+    uint32_t dryS = 0, overflowS = 0; // sekundy poza granicami
+};
+
+static SimResult simulate(const Profile& profile, bool adaptive, bool midSensor, int days) {
+    hostSetMillis(0); // oba tryby na tym samym zegarze
+    SystemState state;
+    Notifier notifier(state);
+    SimPump pump(state, notifier, profile.tank, midSensor);
+    uint32_t peakMask = PumpPolicy::parseHours(profile.peakHours);
+    PumpPolicy tariff; // niezależne rozliczenie pracy w szczycie
+    tariff.configure(false, peakMask);
+
+    hostSetEpoch(START_EPOCH);
+    rngState = 12345;
+
+    pump.configurePolicy(adaptive, peakMask);
+    pump.begin(1, 2, midSensor ? 3 : -1, 4, -1);
+    pump.volume = profile.tank.capacity / 2;
+
+    SimResult result;
+    double usage = 0;
+    bool lastRelay = false;
+    const double dt = STEP_MS / 1000.0;
+    for (uint64_t elapsedMs = 0; elapsedMs < (uint64_t)days * 86400000; elapsedMs += STEP_MS) {
+        int minute = (int)(elapsedMs / 60000 % 1440);
+        if (elapsedMs % 60000 == 0) usage = profile.usage[minute / 60] * jitter();
+
+        pump.volume += ((pump.relay ? profile.tank.pumpRate : 0) - usage) * dt;
+        if (pump.volume < 0) pump.volume = 0;
+
+        hostAdvance(STEP_MS);
+        pump.step();
+
+        if (pump.relay && !lastRelay) result.starts++;
+        lastRelay = pump.relay;
+        if (pump.relay) {
+            result.runS += dt;
+            if (tariff.isPeak(minute)) result.peakRunS += dt;
+        }
+        if (elapsedMs % 1000 == 0) {
+            pump.loop(); // komunikaty zadania jak w loop() na urządzeniu
+            if (pump.volume < profile.tank.dryAt) result.dryS++;
+            if (pump.volume > profile.tank.overflowAt) result.overflowS++;
+        }
+        if (pump.volume < result.minVolume) result.minVolume = pump.volume;
+        if (pump.volume > result.maxVolume) result.maxVolume = pump.volume;
+    }
+    hostAdvance(1000);
+    pump.step(); // ostatnia migawka liczników
+    PumpTaskStats stats;
+    pump.readStats(stats);
+    result.refusals = stats.totalRefusals;
+    return result;
+}
+
+int main(int argc, char** argv) {
+    int days = argc > 1 ? atoi(argv[1]) : 7;
+    if (days < 1) days = 1;
+    configTzTime("UTC0", "pool.ntp.org");
+
+    bool ok = true;
+    printf("%-8s %-3s %-10s %10s %10s %12s %12s %9s %9s  %s\n",
+           "profil", "mid", "tryb", "wlacz/dobe", "blokady/d", "praca/dobe", "szczyt/dobe",
+           "min [l]", "max [l]", "granice");
+    for (const Profile& profile : PROFILES) {
+        for (int mid = 0; mid < 2; mid++) {
+            SimResult baseline;
+            for (int adaptive = 0; adaptive < 2; adaptive++) {
+                SimResult r = simulate(profile, adaptive, mid, days);
+                bool breached = r.dryS || r.overflowS;
+                // Tryb adaptacyjny nie może kupować szczytu dodatkowymi cyklami
+                // przekaźnika ani częstszymi blokadami niż zwykła histereza.
+                bool worse = adaptive && (r.starts > baseline.starts || r.refusals > baseline.refusals);
+                ok = ok && !breached && !worse;
+                printf("%-8s %-3s %-10s %10.1f %10.1f %7.0f min %8.0f min %9.0f %9.0f  %s\n",
+                       profile.name, mid ? "tak" : "nie", adaptive ? "adaptive" : "hysteresis",
+                       r.starts / (double)days, r.refusals / (double)days, r.runS / 60 / days,
+                       r.peakRunS / 60 / days, r.minVolume, r.maxVolume,
+                       breached ? "PRZEKROCZONE" : worse ? "GORSZY" : "ok");
+                if (breached) {
+                    printf("         suchobieg %u s (< %.0f l), przelew %u s (> %.0f l)\n",
+                           r.dryS, profile.tank.dryAt, r.overflowS, profile.tank.overflowAt);
+                }
+                if (worse) {
+                    printf("         histereza: %u wlaczen, %u blokad; adaptive: %u wlaczen, %u blokad\n",
+                           baseline.starts, baseline.refusals, r.starts, r.refusals);
+                }
+                if (!adaptive) baseline = r;
+            }
+        }
+    }
+    return ok ? 0 : 1;
+}